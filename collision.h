@@ -0,0 +1,309 @@
+#pragma once
+
+#include "geometry.h"
+
+// Outcome of a narrow-phase test. normal is a unit vector pointing from the first shape
+// towards the second. For overlapping shapes moving the second one by normal * depth
+// separates them; for disjoint ones normal is a separating axis and -depth > 0 is a lower
+// bound on their distance, exact except between two polygons or bounding circles.
+struct Contact {
+    bool overlap;
+    Point normal;
+    double depth;
+};
+
+// Polygons must be convex; anything else throws std::invalid_argument.
+Contact collide(const Polygon& first, const Polygon& second);
+
+Contact collide(const Polygon& first, const Circle& second);
+
+Contact collide(const Circle& first, const Polygon& second);
+
+Contact collide(const Circle& first, const Circle& second);
+
+// ellipses against anything go through GJK and EPA on their support functions, and so do
+// circles that a non-similarity apply has stretched
+Contact collide(const Shape& first, const Shape& second);
+
+// the pairs are tested on all cores, results in pair order
+std::vector<Contact> collide(std::span<const std::pair<const Shape*, const Shape*>> pairs);
+
+///////////////////////////////////////////////////////////////////////////////////////
+namespace Geometry {
+    // v itself if it is counterclockwise, else a reversed copy kept in storage
+    std::span<const Point> counterclockwise(std::span<const Point> v, std::vector<Point>& storage) {
+        double doubled_area = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            doubled_area += v[i].crossProduct(v[i + 1 == v.size() ? 0 : i + 1]);
+        }
+        if (doubled_area >= 0) return v;
+        storage.assign(v.rbegin(), v.rend());
+        return storage;
+    }
+
+    // the face of a that b lies farthest beyond, both counterclockwise: the separation and the
+    // outward normal. The vertex of b deepest behind the face turns with the faces, so one
+    // walk around b serves all of them, O(n + m).
+    std::pair<double, Point> face_separation(std::span<const Point> a, std::span<const Point> b) {
+        size_t n = a.size();
+        size_t m = b.size();
+        auto next = [m](size_t j) { return j + 1 == m ? 0 : j + 1; };
+        std::pair<double, Point> best = {-std::numeric_limits<double>::infinity(), Point(0, 0)};
+        size_t deepest = m;
+        for (size_t i = 0; i < n; ++i) {
+            Point edge = a[i + 1 == n ? 0 : i + 1] - a[i];
+            double length = edge.len();
+            if (length == 0) continue;
+            Point normal(edge.y / length, -edge.x / length);
+            if (deepest == m) {
+                deepest = 0;
+                for (size_t j = 1; j < m; ++j) {
+                    if (normal.dotProduct(b[j]) < normal.dotProduct(b[deepest])) deepest = j;
+                }
+            } else {
+                for (size_t steps = 0; steps < m && normal.dotProduct(b[next(deepest)]) <= normal.dotProduct(b[deepest]); ++steps) {
+                    deepest = next(deepest);
+                }
+            }
+            double separation = normal.dotProduct(b[deepest] - a[i]);
+            if (separation > best.first) best = {separation, normal};
+        }
+        return best;
+    }
+
+    // closest point to the origin on segment ab as a + t (b - a)
+    double segment_parameter(const Point& a, const Point& b) {
+        Point ab = b - a;
+        double length = ab.dotProduct(ab);
+        return length == 0 ? 0 : std::clamp(-a.dotProduct(ab) / length, 0.0, 1.0);
+    }
+
+    // EPA: grows a polygon inside the Minkowski difference, which contains the origin, until
+    // the edge nearest to the origin is part of the boundary
+    template <typename Support>
+    Contact expanding_polytope(Support support, std::vector<Point> polytope) {
+        static const size_t max_iterations = 64;
+        static const constexpr double tolerance = 1e-10;
+        // the origin is on a vertex or an edge of the simplex; widen it across that edge
+        Point edge = polytope.size() == 2 ? polytope[1] - polytope[0] : Point(1, 0);
+        Point side = edge.dotProduct(edge) == 0 ? Point(0, 1) : Point(-edge.y, edge.x) / edge.len();
+        if (polytope.size() < 3) {
+            polytope.push_back(support(side));
+            polytope.push_back(support(side * -1));
+        }
+        polytope = monotone_chain(polytope);
+        if (polytope.size() < 3) return {true, side, 0};
+        Point normal(1, 0);
+        double depth = 0;
+        for (size_t iteration = 0; iteration < max_iterations; ++iteration) {
+            size_t nearest = 0;
+            depth = std::numeric_limits<double>::infinity();
+            for (size_t i = 0; i < polytope.size(); ++i) {
+                Point edge = polytope[i + 1 == polytope.size() ? 0 : i + 1] - polytope[i];
+                double length = edge.len();
+                if (length == 0) continue;
+                Point outward(edge.y / length, -edge.x / length);
+                double distance = outward.dotProduct(polytope[i]);
+                if (distance < depth) {
+                    depth = distance;
+                    normal = outward;
+                    nearest = i;
+                }
+            }
+            Point w = support(normal);
+            if (normal.dotProduct(w) - depth <= tolerance * std::max(1.0, depth)) break;
+            polytope.insert(polytope.begin() + nearest + 1, w);
+        }
+        return {true, normal, std::max(depth, 0.0)};
+    }
+
+    // GJK distance between two convex sets given by support functions; hands a simplex
+    // around the origin over to EPA
+    template <typename First, typename Second>
+    Contact gjk(First first, Second second) {
+        static const size_t max_iterations = 64;
+        static const constexpr double tolerance = 1e-12;
+        auto support = [&](const Point& d) { return first(d) - second(d * -1); };
+        std::vector<Point> simplex = {support(Point(1, 0))};
+        Point v = simplex[0];
+        for (size_t iteration = 0; iteration < max_iterations; ++iteration) {
+            double squared = v.dotProduct(v);
+            if (squared == 0) return expanding_polytope(support, simplex);
+            Point w = support(v * -1);
+            if (squared - v.dotProduct(w) <= tolerance * squared) break;
+            simplex.push_back(w);
+            if (simplex.size() == 2) {
+                double t = segment_parameter(simplex[0], simplex[1]);
+                v = simplex[0] + (simplex[1] - simplex[0]) * t;
+                if (t == 0) simplex = {simplex[0]};
+                if (t == 1) simplex = {simplex[1]};
+                continue;
+            }
+            const Point& a = simplex[0];
+            const Point& b = simplex[1];
+            const Point& c = simplex[2];
+            int turn = orientation(a, b, c);
+            Point origin(0, 0);
+            if (turn != 0 && orientation(a, b, origin) * turn >= 0 && orientation(b, c, origin) * turn >= 0
+                && orientation(c, a, origin) * turn >= 0) {
+                return expanding_polytope(support, simplex);
+            }
+            // the nearest edge of the triangle, reduced further if its nearest point is an end
+            std::vector<Point> best;
+            double best_squared = std::numeric_limits<double>::infinity();
+            for (auto [p, q] : {std::pair{a, c}, std::pair{b, c}, std::pair{a, b}}) {
+                double t = segment_parameter(p, q);
+                Point closest = p + (q - p) * t;
+                if (closest.dotProduct(closest) < best_squared) {
+                    best_squared = closest.dotProduct(closest);
+                    v = closest;
+                    best = t == 0 ? std::vector<Point>{p} : t == 1 ? std::vector<Point>{q} : std::vector<Point>{p, q};
+                }
+            }
+            simplex = std::move(best);
+        }
+        double distance = v.len();
+        return {false, v * (-1 / distance), -distance};
+    }
+
+    // support point in direction d of the ellipse with the given center, unit long axis and semi-axes
+    Point ellipse_support(const Point& center, const Point& axis, double a, double b, const Point& d) {
+        double along = d.dotProduct(axis);
+        double across = axis.crossProduct(d);
+        double scale = sqrt(a * a * along * along + b * b * across * across);
+        if (scale == 0) return center;
+        return center + axis * (a * a * along / scale) + Point(-axis.y, axis.x) * (b * b * across / scale);
+    }
+
+    // calls function with the support function of whichever of the two is set
+    template <typename Function>
+    Contact with_support(const Polygon* polygon, const Ellipse* ellipse, Function function) {
+        if (polygon) {
+            if (!polygon->isConvex()) throw std::invalid_argument("collide: polygon is not convex");
+            const std::pmr::vector<Point>& v = polygon->getVertices();
+            return function([&v](const Point& d) {
+                size_t best = 0;
+                for (size_t i = 1; i < v.size(); ++i) {
+                    if (d.dotProduct(v[i]) > d.dotProduct(v[best])) best = i;
+                }
+                return v[best];
+            });
+        }
+        auto [first_focus, second_focus] = ellipse->focuses();
+        Point axis = second_focus - first_focus;
+        axis = axis.len() == 0 ? Point(1, 0) : axis / axis.len();
+        auto [a, b] = ellipse->semiAxes();
+        return function([center = ellipse->center(), axis, a, b](const Point& d) {
+            return ellipse_support(center, axis, a, b, d);
+        });
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+Contact collide(const Polygon& first, const Polygon& second) {
+    if (!first.isConvex() || !second.isConvex()) throw std::invalid_argument("collide: polygon is not convex");
+    std::vector<Point> first_storage;
+    std::vector<Point> second_storage;
+    std::span<const Point> a = Geometry::counterclockwise(first.getVertices(), first_storage);
+    std::span<const Point> b = Geometry::counterclockwise(second.getVertices(), second_storage);
+    auto [first_separation, first_normal] = Geometry::face_separation(a, b);
+    auto [second_separation, second_normal] = Geometry::face_separation(b, a);
+    if (first_separation >= second_separation) return {first_separation <= 0, first_normal, -first_separation};
+    return {second_separation <= 0, second_normal * -1, -second_separation};
+}
+
+// the deepest face if the center is inside, else the nearest boundary point
+Contact collide(const Polygon& first, const Circle& second) {
+    if (!second.isRound()) return collide(static_cast<const Shape&>(first), static_cast<const Shape&>(second));
+    if (!first.isConvex()) throw std::invalid_argument("collide: polygon is not convex");
+    std::vector<Point> storage;
+    std::span<const Point> v = Geometry::counterclockwise(first.getVertices(), storage);
+    Point center = second.center();
+    double radius = second.semiAxes().first;
+    auto [separation, normal] = Geometry::face_separation(v, std::span<const Point>(&center, 1));
+    if (separation <= 0) return {true, normal, radius - separation};
+    Point nearest = v[0];
+    double distance = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < v.size(); ++i) {
+        const Point& p = v[i];
+        const Point& q = v[i + 1 == v.size() ? 0 : i + 1];
+        Point closest = p + (q - p) * Geometry::segment_parameter(p - center, q - center);
+        if ((closest - center).len() < distance) {
+            distance = (closest - center).len();
+            nearest = closest;
+        }
+    }
+    return {distance <= radius, (center - nearest) / distance, radius - distance};
+}
+
+Contact collide(const Circle& first, const Polygon& second) {
+    Contact result = collide(second, first);
+    result.normal = result.normal * -1;
+    return result;
+}
+
+Contact collide(const Circle& first, const Circle& second) {
+    if (!first.isRound() || !second.isRound()) {
+        return collide(static_cast<const Shape&>(first), static_cast<const Shape&>(second));
+    }
+    Point offset = second.center() - first.center();
+    double distance = offset.len();
+    double reach = first.semiAxes().first + second.semiAxes().first;
+    Point normal = distance == 0 ? Point(1, 0) : offset / distance;
+    return {distance <= reach, normal, reach - distance};
+}
+
+// bounding circles settle most disjoint pairs before the shapes are looked at
+Contact collide(const Shape& first, const Shape& second) {
+    BoundingCircle first_bound = first.boundingCircle();
+    BoundingCircle second_bound = second.boundingCircle();
+    Point offset = second_bound.center - first_bound.center;
+    double gap = offset.len() - first_bound.radius - second_bound.radius;
+    if (gap > 0) return {false, offset / offset.len(), -gap};
+
+    const Polygon* first_polygon = dynamic_cast<const Polygon*>(&first);
+    const Polygon* second_polygon = dynamic_cast<const Polygon*>(&second);
+    const Ellipse* first_ellipse = dynamic_cast<const Ellipse*>(&first);
+    const Ellipse* second_ellipse = dynamic_cast<const Ellipse*>(&second);
+    const Circle* first_circle = dynamic_cast<const Circle*>(&first);
+    const Circle* second_circle = dynamic_cast<const Circle*>(&second);
+    if (first_circle && !first_circle->isRound()) first_circle = nullptr;
+    if (second_circle && !second_circle->isRound()) second_circle = nullptr;
+    if ((!first_polygon && !first_ellipse) || (!second_polygon && !second_ellipse)) {
+        throw std::invalid_argument("collide: unsupported shape");
+    }
+    if (first_polygon && second_polygon) return collide(*first_polygon, *second_polygon);
+    if (first_circle && second_circle) return collide(*first_circle, *second_circle);
+    if (first_polygon && second_circle) return collide(*first_polygon, *second_circle);
+    if (first_circle && second_polygon) return collide(*first_circle, *second_polygon);
+
+    return Geometry::with_support(first_polygon, first_ellipse, [&](auto first_support) {
+        return Geometry::with_support(second_polygon, second_ellipse, [&](auto second_support) {
+            return Geometry::gjk(first_support, second_support);
+        });
+    });
+}
+
+// a shape may appear in pairs handled by different threads, so its caches are filled first
+std::vector<Contact> collide(std::span<const std::pair<const Shape*, const Shape*>> pairs) {
+    std::vector<const Shape*> shapes;
+    shapes.reserve(2 * pairs.size());
+    for (const auto& pair : pairs) {
+        shapes.push_back(pair.first);
+        shapes.push_back(pair.second);
+    }
+    std::sort(shapes.begin(), shapes.end());
+    shapes.erase(std::unique(shapes.begin(), shapes.end()), shapes.end());
+    Geometry::parallel_for(shapes.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            shapes[i]->precompute();
+        }
+    }, 64);
+    std::vector<Contact> result(pairs.size());
+    Geometry::parallel_for(pairs.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            result[i] = collide(*pairs[i].first, *pairs[i].second);
+        }
+    });
+    return result;
+}
@@ -0,0 +1,104 @@
+// g++ -std=c++20 -O2 -pthread collision_test.cpp -o collision_test && ./collision_test
+// Exits with a failed assertion if a narrow-phase test reports the wrong overlap or depth.
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "collision.h"
+
+bool near(double actual, double expected, double tolerance = 1e-6) {
+    return std::fabs(actual - expected) <= tolerance;
+}
+
+void polygons() {
+    Polygon square({Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)});
+    Polygon overlapping({Point(1.5, 0.5), Point(3.5, 0.5), Point(3.5, 1.5), Point(1.5, 1.5)});
+    Contact contact = collide(square, overlapping);
+    assert(contact.overlap);
+    assert(near(contact.depth, 0.5));
+    assert(near(contact.normal.x, 1) && near(contact.normal.y, 0));
+
+    Polygon apart({Point(5, 0), Point(6, 0), Point(6, 1), Point(5, 1)});
+    contact = collide(square, apart);
+    assert(!contact.overlap);
+    assert(near(contact.depth, -3));
+
+    // clockwise input is accepted, a concave polygon is not
+    Polygon clockwise({Point(1, 1), Point(1, 3), Point(3, 3), Point(3, 1)});
+    assert(collide(square, clockwise).overlap);
+    Polygon concave({Point(0, 0), Point(4, 0), Point(4, 4), Point(2, 1), Point(0, 4)});
+    bool thrown = false;
+    try {
+        collide(square, concave);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void circles() {
+    Circle unit(Point(0, 0), 1);
+    Circle touching(Point(1.5, 0), 1);
+    Contact contact = collide(unit, touching);
+    assert(contact.overlap && near(contact.depth, 0.5) && near(contact.normal.x, 1));
+
+    Polygon square({Point(2, -1), Point(4, -1), Point(4, 1), Point(2, 1)});
+    contact = collide(unit, square);
+    assert(!contact.overlap && near(contact.depth, -1));
+    assert(near(contact.normal.x, 1) && near(contact.normal.y, 0));
+    contact = collide(square, Circle(Point(3, 0), 0.5));
+    assert(contact.overlap && near(contact.depth, 1.5));
+}
+
+// a circle stretched along x is an ellipse with semi-axes 3 and 1; the unit circle at
+// (0, 2.9) lies 0.9 above it, although the radii 3 and 1 would reach 4
+void stretched_circle() {
+    Circle stretched(Point(0, 0), 1);
+    stretched.apply(AffineTransform(3, 0, 0, 1, 0, 0));
+    Circle above(Point(0, 2.9), 1);
+    for (Contact contact : {collide(stretched, above), collide(static_cast<const Shape&>(stretched), above)}) {
+        assert(!contact.overlap);
+        assert(near(contact.depth, -0.9));
+    }
+    Contact contact = collide(stretched, Circle(Point(3.5, 0), 1));
+    assert(contact.overlap && near(contact.depth, 0.5));
+    Polygon slab({Point(-5, 1.5), Point(5, 1.5), Point(5, 2), Point(-5, 2)});
+    assert(!collide(stretched, slab).overlap);
+}
+
+void ellipses() {
+    Ellipse ellipse(Point(-2, 0), Point(2, 0), 6);
+    Polygon beside({Point(3.5, -1), Point(5, -1), Point(5, 1), Point(3.5, 1)});
+    Contact contact = collide(ellipse, beside);
+    assert(!contact.overlap && near(contact.depth, -0.5));
+    Polygon inside({Point(2.5, -0.5), Point(4, -0.5), Point(4, 0.5), Point(2.5, 0.5)});
+    contact = collide(ellipse, inside);
+    assert(contact.overlap && near(contact.depth, 0.5, 1e-4));
+}
+
+// the span overload gives the pairwise answers in order
+void batch() {
+    std::vector<Circle> circles;
+    for (int i = 0; i < 40; ++i) {
+        circles.emplace_back(Point(i * 1.5, 0), 1);
+    }
+    std::vector<std::pair<const Shape*, const Shape*>> pairs;
+    for (size_t i = 0; i < circles.size(); ++i) {
+        for (size_t j = 0; j < circles.size(); ++j) {
+            pairs.push_back({&circles[i], &circles[j]});
+        }
+    }
+    std::vector<Contact> contacts = collide(pairs);
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        Contact expected = collide(*pairs[k].first, *pairs[k].second);
+        assert(contacts[k].overlap == expected.overlap && contacts[k].depth == expected.depth);
+    }
+}
+
+int main() {
+    polygons();
+    circles();
+    stretched_circle();
+    ellipses();
+    batch();
+}
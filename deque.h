@@ -1,5 +1,31 @@
 #include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Deque snapshot file, native byte order, every header field 8 bytes:
+//   header: magic "DEQUEBIN", uint64 version, uint64 block size, uint64 element size,
+//           uint64 element count
+//   then the elements, contiguous, as written from the blocks
+namespace DequeFormat {
+    static const constexpr char magic[8] = {'D', 'E', 'Q', 'U', 'E', 'B', 'I', 'N'};
+    static const constexpr uint64_t version = 1;
+    static const constexpr size_t header_size = 40;
+}
 
 template <typename T>
 class Deque {
@@ -109,6 +135,8 @@ public:
 
 private:
     static const size_t BLOCK_SIZE = 64;
+    // blocks per thread at least in the parallel algorithms
+    static const size_t PARALLEL_GRAIN = 256;
     size_t min_row;
     size_t min_col;
     size_t size_;
@@ -172,6 +200,227 @@ private:
         clear(capacity, true);
     }
 
+    // splits [0, count) into about equal ranges of at least grain, one per core
+    static size_t parallel_parts(size_t count, size_t grain = PARALLEL_GRAIN) {
+        size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        return std::max<size_t>(1, std::min(threads, (count + grain - 1) / grain));
+    }
+
+    // runs function(part, first, last) for parts consecutive ranges of [0, count), each on
+    // its own thread; an exception escaping function calls std::terminate
+    template <typename Function>
+    static void parallel_for(size_t parts, size_t count, Function function) {
+        size_t chunk = (count + parts - 1) / parts;
+        auto run = [&](size_t part) noexcept {
+            size_t first = std::min(count, part * chunk);
+            function(part, first, std::min(count, first + chunk));
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(parts - 1);
+        for (size_t part = 1; part < parts; ++part) {
+            workers.emplace_back(run, part);
+        }
+        run(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    size_t blocks() const {
+        return size_ == 0 ? 0 : (min_col + size_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    }
+
+    // position in the deque of the first element of block b, counting from the first block in use
+    size_t block_start(size_t b) const {
+        return b == 0 ? 0 : std::min(size_, b * BLOCK_SIZE - min_col);
+    }
+
+    // calls function(first, last, index) with the elements of blocks [first_block, last_block),
+    // index being the position of *first in the deque
+    template <typename Function>
+    void each_block(size_t first_block, size_t last_block, Function function) const {
+        for (size_t b = first_block; b < last_block; ++b) {
+            size_t lower = b == 0 ? min_col : 0;
+            size_t upper = std::min(size_t(BLOCK_SIZE), min_col + size_ - b * BLOCK_SIZE);
+            function(arr[min_row + b] + lower, arr[min_row + b] + upper, block_start(b));
+        }
+    }
+
+    iterator iterator_at(size_t index) {
+        size_t position = min_col + index;
+        return {arr, min_row + position / BLOCK_SIZE, position % BLOCK_SIZE};
+    }
+
+    // how many of the first k elements of the stable merge of runs a and b come from a
+    template <typename Source, typename Compare>
+    static size_t co_rank(size_t k, size_t a, size_t a_size, size_t b, size_t b_size, Source source, Compare& comp) {
+        size_t lo = k > b_size ? k - b_size : 0;
+        size_t hi = std::min(k, a_size);
+        while (lo < hi) {
+            size_t i = lo + (hi - lo) / 2;
+            if (comp(*source(b + k - i - 1), *source(a + i))) {
+                hi = i;
+            } else {
+                lo = i + 1;
+            }
+        }
+        return lo;
+    }
+
+    template <typename Input, typename Output, typename Compare>
+    static void merge(Input a, Input a_end, Input b, Input b_end, Output out, Compare& comp) {
+        for (; a != a_end && b != b_end; ++out) {
+            if (comp(*b, *a)) {
+                *out = std::move(*b);
+                ++b;
+            } else {
+                *out = std::move(*a);
+                ++a;
+            }
+        }
+        for (; a != a_end; ++a, ++out) {
+            *out = std::move(*a);
+        }
+        for (; b != b_end; ++b, ++out) {
+            *out = std::move(*b);
+        }
+    }
+
+    // merges runs 0 and 1, 2 and 3 and so on from source into target, cut into about parts
+    // pieces of equal length that merge independently; bounds then delimits the merged runs.
+    // Merging moves out of source, so all pieces are cut before any is merged.
+    template <typename Source, typename Target, typename Compare>
+    void merge_round(std::vector<size_t>& bounds, size_t parts, Source source, Target target, Compare& comp) {
+        struct Piece {
+            size_t a;
+            size_t a_end;
+            size_t b;
+            size_t b_end;
+            size_t out;
+        };
+        size_t piece = (size_ + parts - 1) / parts;
+        size_t last_bound = bounds.size() - 1;
+        std::vector<Piece> pieces;
+        std::vector<size_t> run;
+        for (size_t r = 0; r < last_bound; r += 2) {
+            for (size_t k = bounds[r]; k < bounds[std::min(r + 2, last_bound)]; k += piece) {
+                pieces.push_back({0, 0, 0, 0, k});
+                run.push_back(r);
+            }
+        }
+        parallel_for(pieces.size(), pieces.size(), [&](size_t, size_t first, size_t last) {
+            for (size_t p = first; p < last; ++p) {
+                size_t a = bounds[run[p]];
+                size_t b = bounds[run[p] + 1];
+                size_t b_end = bounds[std::min(run[p] + 2, last_bound)];
+                size_t out_last = std::min(b_end, pieces[p].out + piece);
+                size_t i = co_rank(pieces[p].out - a, a, b - a, b, b_end - b, source, comp);
+                size_t i_end = co_rank(out_last - a, a, b - a, b, b_end - b, source, comp);
+                pieces[p].a = a + i;
+                pieces[p].a_end = a + i_end;
+                pieces[p].b = b + (pieces[p].out - a - i);
+                pieces[p].b_end = b + (out_last - a - i_end);
+            }
+        });
+        parallel_for(pieces.size(), pieces.size(), [&](size_t, size_t first, size_t last) {
+            for (size_t p = first; p < last; ++p) {
+                const Piece& cut = pieces[p];
+                merge(source(cut.a), source(cut.a_end), source(cut.b), source(cut.b_end), target(cut.out), comp);
+            }
+        });
+        std::vector<size_t> merged;
+        for (size_t r = 0; r < bounds.size(); r += 2) {
+            merged.push_back(bounds[r]);
+        }
+        if (merged.back() != bounds.back()) merged.push_back(bounds.back());
+        bounds.swap(merged);
+    }
+
+    // The elements are moved out to a buffer, every thread sorts the run of whole blocks
+    // it moved, and pairs of runs are merged back and forth between the buffer and the
+    // blocks, each round cut into equal pieces for all threads.
+    template <bool Stable, typename Compare>
+    void parallel_sort(Compare comp) {
+        if (size_ < 2) return;
+        size_t count = blocks();
+        size_t parts = parallel_parts(count);
+        std::allocator<T> allocator;
+        T* buffer = allocator.allocate(size_);
+        std::vector<size_t> bounds(parts + 1, 0);
+        parallel_for(parts, count, [&](size_t part, size_t first, size_t last) {
+            each_block(first, last, [buffer](T* from, T* to, size_t index) {
+                std::uninitialized_move(from, to, buffer + index);
+            });
+            bounds[part + 1] = block_start(last);
+            if constexpr (Stable) {
+                std::stable_sort(buffer + block_start(first), buffer + block_start(last), comp);
+            } else {
+                std::sort(buffer + block_start(first), buffer + block_start(last), comp);
+            }
+        });
+        auto in_buffer = [buffer](size_t index) { return buffer + index; };
+        auto in_blocks = [this](size_t index) { return iterator_at(index); };
+        bool in_place = false;
+        for (; bounds.size() > 2; in_place = !in_place) {
+            if (in_place) {
+                merge_round(bounds, parts, in_blocks, in_buffer, comp);
+            } else {
+                merge_round(bounds, parts, in_buffer, in_blocks, comp);
+            }
+        }
+        parallel_for(parts, count, [&](size_t, size_t first, size_t last) {
+            each_block(first, last, [buffer, in_place](T* from, T* to, size_t index) {
+                if (!in_place) std::move(buffer + index, buffer + index + (to - from), from);
+                std::destroy(buffer + index, buffer + index + (to - from));
+            });
+        });
+        allocator.deallocate(buffer, size_);
+    }
+
+    // io (writev or readv) until all of pieces is through, resuming after short transfers
+    template <typename Io>
+    static void transfer(int fd, iovec* pieces, size_t count, Io io, const std::string& path) {
+        while (count) {
+            ssize_t done = io(fd, pieces, static_cast<int>(count));
+            if (done < 0 && errno == EINTR) continue;
+            if (done < 0) throw std::system_error(errno, std::generic_category(), path);
+            if (done == 0) throw std::runtime_error("Deque: " + path + " ended early");
+            size_t left = done;
+            while (count && left >= pieces->iov_len) {
+                left -= pieces->iov_len;
+                ++pieces;
+                --count;
+            }
+            if (count) {
+                pieces->iov_base = static_cast<char*>(pieces->iov_base) + left;
+                pieces->iov_len -= left;
+            }
+        }
+    }
+
+    // io over leading and then every block in use, one call for up to IOV_MAX pieces
+    template <typename Io>
+    void transfer_blocks(int fd, std::vector<iovec> leading, Io io, const std::string& path) const {
+        std::vector<iovec> pieces = std::move(leading);
+        pieces.reserve(IOV_MAX);
+        each_block(0, blocks(), [&](T* first, T* last, size_t) {
+            pieces.push_back({first, static_cast<size_t>(last - first) * sizeof(T)});
+            if (pieces.size() == IOV_MAX) {
+                transfer(fd, pieces.data(), pieces.size(), io, path);
+                pieces.clear();
+            }
+        });
+        transfer(fd, pieces.data(), pieces.size(), io, path);
+    }
+
+    struct Uninitialized {};
+
+    // size elements in fresh blocks, left for restore to read in
+    Deque(Uninitialized, size_t size): min_row(0), min_col(0), size_(size)
+        , capacity(std::max<size_t>(1, (size + BLOCK_SIZE - 1) / BLOCK_SIZE)) {
+        init();
+    }
+
     void init() {
         bool arr_created = false;
         size_t row = 0;
@@ -430,4 +679,112 @@ public:
         }
         pop_back();
     }
+
+    // Parallel algorithms. Work is split along blocks, so that every thread goes through
+    // whole blocks by pointer. As with the standard parallel algorithms, an exception
+    // escaping an element operation calls std::terminate.
+
+    // function(element) for every element
+    template <typename Function>
+    void for_each(Function function) {
+        parallel_for(parallel_parts(blocks()), blocks(), [&](size_t, size_t first, size_t last) {
+            each_block(first, last, [&](T* from, T* to, size_t) {
+                for (; from != to; ++from) {
+                    function(*from);
+                }
+            });
+        });
+    }
+
+    // replaces every element with function(element)
+    template <typename Function>
+    void transform(Function function) {
+        for_each([&](T& element) { element = function(std::as_const(element)); });
+    }
+
+    // init combined once with all elements in order by op, which must be associative. The
+    // other threads fold from their first element, so when U cannot be built from T the
+    // whole fold runs on one thread
+    template <typename U, typename BinaryOp>
+    U reduce(U init, BinaryOp op) const {
+        static const constexpr bool split = std::is_constructible_v<U, const T&>;
+        size_t parts = split ? parallel_parts(blocks()) : 1;
+        std::vector<std::optional<U>> partial(parts);
+        partial[0].emplace(std::move(init));
+        parallel_for(parts, blocks(), [&](size_t part, size_t first, size_t last) {
+            each_block(first, last, [&](const T* from, const T* to, size_t) {
+                for (; from != to; ++from) {
+                    if (partial[part]) {
+                        partial[part] = op(std::move(*partial[part]), *from);
+                    } else if constexpr (split) {
+                        partial[part].emplace(*from);
+                    }
+                }
+            });
+        });
+        if constexpr (split) {
+            for (size_t part = 1; part < parts; ++part) {
+                if (partial[part]) partial[0] = op(std::move(*partial[0]), std::move(*partial[part]));
+            }
+        }
+        return std::move(*partial[0]);
+    }
+
+    // both take an extra size() elements of memory while sorting
+    template <typename Compare = std::less<T>>
+    void sort(Compare comp = Compare()) {
+        parallel_sort<false>(comp);
+    }
+
+    template <typename Compare = std::less<T>>
+    void stable_sort(Compare comp = Compare()) {
+        parallel_sort<true>(comp);
+    }
+
+    // Binary snapshot in the DequeFormat layout, written block by block with writev and
+    // read straight into fresh blocks with readv. Throw std::system_error when I/O fails
+    // and std::runtime_error for a file that is not a snapshot of this element type.
+    // Elements are stored contiguously, so a snapshot restores whatever the block size.
+    void snapshot(const std::string& path) const requires std::is_trivially_copyable_v<T> {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        uint64_t header[DequeFormat::header_size / sizeof(uint64_t)] = {
+            0, DequeFormat::version, BLOCK_SIZE, sizeof(T), size_};
+        std::memcpy(header, DequeFormat::magic, sizeof(DequeFormat::magic));
+        try {
+            transfer_blocks(fd, {{header, sizeof(header)}}, ::writev, path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        if (::close(fd) < 0) throw std::system_error(errno, std::generic_category(), path);
+    }
+
+    // replaces the contents with the snapshot at path
+    void restore(const std::string& path) requires std::is_trivially_copyable_v<T> {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        try {
+            struct stat info;
+            if (::fstat(fd, &info) < 0) throw std::system_error(errno, std::generic_category(), path);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            uint64_t header[DequeFormat::header_size / sizeof(uint64_t)];
+            iovec piece = {header, sizeof(header)};
+            size_t length = info.st_size;
+            if (length < sizeof(header)) throw std::runtime_error("Deque: " + path + " is not a snapshot");
+            transfer(fd, &piece, 1, ::readv, path);
+            if (std::memcmp(header, DequeFormat::magic, sizeof(DequeFormat::magic)) != 0
+                || header[1] != DequeFormat::version || header[3] != sizeof(T)) {
+                throw std::runtime_error("Deque: " + path + " is not a snapshot of this element type");
+            }
+            if (header[4] > (length - sizeof(header)) / sizeof(T)) throw std::runtime_error("Deque: " + path + " is truncated");
+            Deque restored(Uninitialized{}, header[4]);
+            restored.transfer_blocks(fd, {}, ::readv, path);
+            swap(restored);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,222 @@
+// g++ -std=c++20 -O2 -pthread deque_test.cpp -o deque_test && ./deque_test
+// Exits with a failed assertion if a parallel Deque algorithm disagrees with the sequential one
+// or a snapshot does not restore what was saved.
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "deque.h"
+
+// Reports eight hardware threads whatever the machine has, so the algorithms really split
+// their input. Deque asks std::thread, and the definition here takes precedence over the
+// library's.
+unsigned int std::thread::hardware_concurrency() noexcept {
+    return 8;
+}
+
+// 200k elements are enough blocks for eight parts; the first block is partly filled
+Deque<int> numbers() {
+    Deque<int> d;
+    for (int i = 0; i < 100000; ++i) {
+        d.push_back(i * 7 % 1000);
+        d.push_front(i % 13 - 6);
+    }
+    return d;
+}
+
+// init is applied once however many threads take part
+void reduce_applies_init_once() {
+    Deque<int> d = numbers();
+    long long expected = std::accumulate(d.begin(), d.end(), 10LL);
+    assert(d.reduce(10LL, std::plus<>()) == expected);
+    Deque<int> empty;
+    assert(empty.reduce(10LL, std::plus<>()) == 10);
+}
+
+// string concatenation is associative but not commutative
+void reduce_keeps_order() {
+    Deque<int> d;
+    std::string expected = "init:";
+    for (int i = 0; i < 50000; ++i) {
+        d.push_back(i % 10);
+        expected += char('0' + i % 10);
+    }
+    std::string result = d.reduce(std::string("init:"), [](std::string lhs, const auto& rhs) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(rhs)>, int>) {
+            lhs += char('0' + rhs);
+        } else {
+            lhs += rhs;
+        }
+        return lhs;
+    });
+    assert(result == expected);
+}
+
+// pair cannot become a long, so op is only ever called as op(long, pair)
+void reduce_into_other_type() {
+    Deque<std::pair<int, int>> d;
+    long expected = 5;
+    for (int i = 0; i < 20000; ++i) {
+        d.push_back({i, -2 * i});
+        expected -= i;
+    }
+    long result = d.reduce(5L, [](long lhs, const std::pair<int, int>& rhs) { return lhs + rhs.first + rhs.second; });
+    assert(result == expected);
+}
+
+std::vector<int> contents(const Deque<int>& d) {
+    return std::vector<int>(d.begin(), d.end());
+}
+
+// every element is visited once, in place, whatever the part it falls in
+void for_each_and_transform() {
+    Deque<int> d = numbers();
+    std::vector<int> expected = contents(d);
+    d.for_each([](int& x) { x = x * 3 + 1; });
+    for (int& x : expected) x = x * 3 + 1;
+    assert(contents(d) == expected);
+    d.transform([](const int& x) { return x / 2 - 7; });
+    for (int& x : expected) x = x / 2 - 7;
+    assert(contents(d) == expected);
+    Deque<int> empty;
+    empty.for_each([](int&) { assert(false); });
+}
+
+// sort gives std::sort's order for many duplicates, a custom comparator, an offset first
+// block and sizes around one block
+void sort_matches_std() {
+    Deque<int> d = numbers();
+    std::vector<int> expected = contents(d);
+    d.sort();
+    std::sort(expected.begin(), expected.end());
+    assert(contents(d) == expected);
+    d.sort(std::greater<int>());
+    std::sort(expected.begin(), expected.end(), std::greater<int>());
+    assert(contents(d) == expected);
+    for (int n : {0, 1, 63, 64, 65, 1000}) {
+        Deque<int> small;
+        for (int i = 0; i < n; ++i) {
+            small.push_front(i * 37 % 101);
+        }
+        std::vector<int> sorted = contents(small);
+        small.sort();
+        std::sort(sorted.begin(), sorted.end());
+        assert(contents(small) == sorted);
+    }
+}
+
+// equal keys keep their original order
+void stable_sort_keeps_ties() {
+    Deque<std::pair<int, int>> d;
+    for (int i = 0; i < 150000; ++i) {
+        if (i % 2) {
+            d.push_back({i * 7 % 100, i});
+        } else {
+            d.push_front({i * 7 % 100, i});
+        }
+    }
+    std::vector<std::pair<int, int>> expected(d.begin(), d.end());
+    auto by_key = [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) { return lhs.first < rhs.first; };
+    d.stable_sort(by_key);
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    assert(std::equal(d.begin(), d.end(), expected.begin(), expected.end()));
+}
+
+std::string scratch(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template <typename Exception, typename Function>
+bool throws(Function function) {
+    try {
+        function();
+    } catch (const Exception&) {
+        return true;
+    }
+    return false;
+}
+
+struct Sample {
+    double weight;
+    int id;
+    char tag;
+};
+
+// more blocks than one writev takes, a partly filled first block, a struct with padding and
+// an empty deque all come back as they were and keep working afterwards
+void snapshot_round_trip() {
+    std::string path = scratch("deque_test.bin");
+    Deque<int> d = numbers();
+    d.pop_front();
+    d.snapshot(path);
+    Deque<int> restored;
+    restored.push_back(42);
+    restored.restore(path);
+    assert(contents(restored) == contents(d));
+    restored.push_front(-1);
+    restored.push_back(-2);
+    assert(restored.size() == d.size() + 2 && restored[0] == -1 && restored[restored.size() - 1] == -2);
+
+    Deque<Sample> samples;
+    for (int i = 0; i < 1000; ++i) {
+        samples.push_front({i / 3.0, i, char('a' + i % 26)});
+    }
+    samples.snapshot(path);
+    Deque<Sample> loaded;
+    loaded.restore(path);
+    assert(loaded.size() == samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        assert(loaded[i].weight == samples[i].weight && loaded[i].id == samples[i].id && loaded[i].tag == samples[i].tag);
+    }
+
+    Deque<int> empty;
+    empty.snapshot(path);
+    restored.restore(path);
+    assert(restored.size() == 0);
+    restored.push_back(7);
+    assert(restored.size() == 1 && restored[0] == 7);
+    std::remove(path.c_str());
+}
+
+// a missing file, a foreign file, another element type and a truncated snapshot are refused
+// and leave the deque as it was
+void snapshot_errors() {
+    std::string path = scratch("deque_test.bin");
+    Deque<int> d;
+    for (int i = 0; i < 500; ++i) {
+        d.push_back(i);
+    }
+    std::vector<int> before = contents(d);
+    assert(throws<std::system_error>([&] { d.restore(scratch("deque_test_missing.bin")); }));
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a deque snapshot, but longer than the header is";
+    }
+    assert(throws<std::runtime_error>([&] { d.restore(path); }));
+    Deque<double> doubles(100, 1.5);
+    doubles.snapshot(path);
+    assert(throws<std::runtime_error>([&] { d.restore(path); }));
+    Deque<int> longer(1000, 3);
+    longer.snapshot(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 10);
+    assert(throws<std::runtime_error>([&] { d.restore(path); }));
+    assert(contents(d) == before);
+    std::remove(path.c_str());
+}
+
+int main() {
+    reduce_applies_init_once();
+    reduce_keeps_order();
+    reduce_into_other_type();
+    for_each_and_transform();
+    sort_matches_std();
+    stable_sort_keeps_ties();
+    snapshot_round_trip();
+    snapshot_errors();
+}
@@ -1,125 +1,450 @@
+#pragma once
+
 #include <iostream>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
+// per-coordinate-type tolerances; exact types compare and orient without them
+template <typename T>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<double> {
+    using real = double;
+    using wide = double;
+    static const constexpr bool exact = false;
+    static const constexpr double point_eps = 1e-7;
+    static const constexpr double line_eps = 1e-9;
+    static const constexpr double shape_eps = 1e-7;
+};
+
+template <>
+struct ScalarTraits<float> {
+    using real = float;
+    using wide = double;
+    static const constexpr bool exact = false;
+    static const constexpr float point_eps = 1e-4f;
+    static const constexpr float line_eps = 1e-5f;
+    static const constexpr float shape_eps = 1e-4f;
+};
+
+template <>
+struct ScalarTraits<int64_t> {
+    using real = double;
+    __extension__ typedef __int128 wide;
+    static const constexpr bool exact = true;
+    static const constexpr int64_t point_eps = 0;
+    static const constexpr int64_t line_eps = 0;
+    static const constexpr int64_t shape_eps = 0;
+};
+
 namespace Geometry {
-    bool equal(double first, double second, double eps) {
-        return fabs(first - second) < eps;
+    template <typename T>
+    bool equal(T first, T second, T eps) {
+        if constexpr (ScalarTraits<T>::exact) {
+            return first == second;
+        } else {
+            return std::fabs(first - second) < eps;
+        }
+    }
+
+    // True if second is a cyclic shift of first. eq is usually a tolerance, which is not
+    // transitive, so string matching that reuses earlier comparisons could miss a shift; every
+    // shift is compared directly instead and abandoned at its first mismatch. That is O(n) when
+    // wrong shifts fail early and O(n^2) for nearly periodic sequences.
+    template <typename First, typename Second, typename Equal>
+    bool cyclic_shift(const First& first, const Second& second, Equal eq) {
+        size_t n = first.size();
+        if (n != second.size()) return false;
+        if (n == 0) return true;
+        for (size_t shift = 0; shift < n; ++shift) {
+            size_t k = 0;
+            for (size_t j = shift; k < n && eq(first[k], second[j]); ++k) {
+                j = j + 1 == n ? 0 : j + 1;
+            }
+            if (k == n) return true;
+        }
+        return false;
+    }
+
+    // runs function(first, last) over consecutive chunks of [0, count) on all cores
+    template <typename Function>
+    void parallel_for(size_t count, Function function, size_t grain = 1024) {
+        size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        threads = std::min(threads, (count + grain - 1) / grain);
+        if (threads <= 1) {
+            if (count) function(size_t(0), count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        size_t chunk = (count + threads - 1) / threads;
+        for (size_t t = 1; t < threads; ++t) {
+            size_t first = std::min(count, t * chunk);
+            size_t last = std::min(count, first + chunk);
+            workers.emplace_back([=, &function] { function(first, last); });
+        }
+        function(size_t(0), std::min(count, chunk));
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // start of the lexicographically least rotation
+    template <typename T>
+    size_t least_rotation(const std::vector<T>& s) {
+        size_t n = s.size();
+        size_t i = 0;
+        size_t j = 1;
+        size_t k = 0;
+        while (i < n && j < n && k < n) {
+            const T& a = s[(i + k) % n];
+            const T& b = s[(j + k) % n];
+            if (a == b) {
+                ++k;
+                continue;
+            }
+            if (b < a) {
+                i += k + 1;
+            } else {
+                j += k + 1;
+            }
+            if (i == j) ++j;
+            k = 0;
+        }
+        return std::min(i, j);
     }
 }
 
-struct Point;
+template <typename T>
+struct BasicPoint;
 
-class Line {
+template <typename T>
+class BasicLine {
 public:
-    Line(): a(1), b(-1), c(0) {}
+    using Point = BasicPoint<T>;
+
+    BasicLine(): a(1), b(-1), c(0) {}
 
-    Line(const Point& first, const Point& second);
+    BasicLine(const Point& first, const Point& second);
 
-    Line(const double& m, const double& dist);
+    BasicLine(const T& m, const T& dist);
 
-    Line(const Point& v, const double& m);
+    BasicLine(const Point& v, const T& m);
 
-    Line perp(const Point& v) const;
+    BasicLine perp(const Point& v) const;
 
-    Point operator*(const Line& other) const;
+    Point operator*(const BasicLine& other) const;
 
-    double get_coef() const;
+    T get_coef() const;
 
-    double dist(const Point& p) const;
+    typename ScalarTraits<T>::real dist(const Point& p) const;
 
-    bool operator==(const Line& other) const;
+    bool operator==(const BasicLine& other) const;
 
     void norm();
 
-    double a;
-    double b;
-    double c;
+    T a;
+    T b;
+    T c;
 
     static const constexpr double pi = 3.141592653589793238;
-    static const constexpr double eps = 1e-9;
+    static const constexpr T eps = ScalarTraits<T>::line_eps;
 };
 /////////////////////////////////////////////////
-struct Point {
-    double x;
-    double y;
+template <typename T>
+struct BasicPoint {
+    using Line = BasicLine<T>;
+
+    T x;
+    T y;
     static const constexpr double pi = 3.141592653589793238;
-    static const constexpr double eps = 1e-7;
+    static const constexpr T eps = ScalarTraits<T>::point_eps;
+
+    BasicPoint() : x(0), y(0) {}
 
-    Point() : x(0), y(0) {}
+    BasicPoint(T x_, T y_) : x(x_), y(y_) {}
 
-    Point(double x_, double y_) : x(x_), y(y_) {}
+    template <typename U>
+    explicit BasicPoint(const BasicPoint<U>& other): x(static_cast<T>(other.x)), y(static_cast<T>(other.y)) {}
 
-    Point(const Point &other): x(other.x), y(other.y) {}
+    BasicPoint(const BasicPoint &other) = default;
 
-    Point& operator=(const Point &other) = default;
+    BasicPoint& operator=(const BasicPoint &other) = default;
 
-    bool operator==(const Point &other) const {
+    bool operator==(const BasicPoint &other) const {
         return Geometry::equal(x, other.x, eps) && Geometry::equal(y, other.y, eps);
     }
 
-    Point operator+(const Point &other) const {
-        return Point{x + other.x, y + other.y};
+    BasicPoint operator+(const BasicPoint &other) const {
+        return BasicPoint{x + other.x, y + other.y};
     }
 
-    Point operator-(const Point &other) const {
-        return Point{x - other.x, y - other.y};
+    BasicPoint operator-(const BasicPoint &other) const {
+        return BasicPoint{x - other.x, y - other.y};
     }
 
-    Point& operator+=(const Point &other) {
+    BasicPoint& operator+=(const BasicPoint &other) {
         return *this = *this + other;
     }
 
-    Point& operator-=(const Point &other) {
+    BasicPoint& operator-=(const BasicPoint &other) {
         return *this = *this - other;
     }
 
-    Point operator/(const double &dec) const {
-        return *this * (1 / dec);
+    BasicPoint operator/(const T &dec) const {
+        if constexpr (ScalarTraits<T>::exact) {
+            return BasicPoint{x / dec, y / dec};
+        } else {
+            return *this * (1 / dec);
+        }
     }
 
-    double dotProduct(const Point &other) const {
+    T dotProduct(const BasicPoint &other) const {
         return x * other.x + y * other.y;
     }
 
-    double crossProduct(const Point &other) const {
+    T crossProduct(const BasicPoint &other) const {
         return x * other.y - y * other.x;
     }
 
-    double len() const {
-        return sqrt(x * x + y * y);
+    typename ScalarTraits<T>::real len() const {
+        using Real = typename ScalarTraits<T>::real;
+        return std::sqrt(Real(x) * Real(x) + Real(y) * Real(y));
     }
 
-    Point operator*(double t) const {
-        return Point{x * t, y * t};
+    BasicPoint operator*(T t) const {
+        return BasicPoint{x * t, y * t};
     }
 
-    void reflect(const Point& p) {
+    void reflect(const BasicPoint& p) {
         *this -= (*this - p) * 2;
     }
 
-    void reflect(const Line& l) {
-        Point center = l * l.perp(*this);
+    void reflect(const Line& l) requires std::floating_point<T> {
+        BasicPoint center = l * l.perp(*this);
         reflect(center);
     }
 
-    void rotate(const Point& center, double angle) {
-        Point crt = *this - center;
+    void rotate(const BasicPoint& center, T angle) requires std::floating_point<T> {
+        BasicPoint crt = *this - center;
         angle /= 180 / pi;
-        Point res{crt.x * cos(angle) - crt.y * sin(angle), crt.x * sin(angle) + crt.y * cos(angle)};
+        BasicPoint res{crt.x * std::cos(angle) - crt.y * std::sin(angle), crt.x * std::sin(angle) + crt.y * std::cos(angle)};
         *this = center + res;
     }
 
-    void scale(const Point& center, double coefficient) {
+    void scale(const BasicPoint& center, T coefficient) {
         *this = center + (*this - center) * coefficient;
     }
 };
 
+using Point = BasicPoint<double>;
+
+using Line = BasicLine<double>;
+
+// Adaptive-precision predicates after Shewchuk. The determinant is evaluated in doubles
+// first and its sign is returned when it exceeds a bound on the rounding error; only
+// inputs closer to degenerate than that are recomputed exactly. An expansion is a sum of
+// non-overlapping doubles in increasing magnitude, so its sign is that of its last term.
+namespace Geometry {
+    static const constexpr double epsilon = std::numeric_limits<double>::epsilon() / 2;
+    static const constexpr double orient_bound = (3 + 16 * epsilon) * epsilon;
+    static const constexpr double incircle_bound = (10 + 96 * epsilon) * epsilon;
+
+    using Expansion = std::vector<double>;
+
+    void two_sum(double a, double b, double& sum, double& error) {
+        sum = a + b;
+        double b_virtual = sum - a;
+        double a_virtual = sum - b_virtual;
+        error = (a - a_virtual) + (b - b_virtual);
+    }
+
+    Expansion exact_difference(double a, double b) {
+        double difference = a - b;
+        double b_virtual = a - difference;
+        double a_virtual = difference + b_virtual;
+        double error = (a - a_virtual) + (b_virtual - b);
+        return error == 0 ? Expansion{difference} : Expansion{error, difference};
+    }
+
+    // adds one double to an expansion, dropping zero terms
+    Expansion grow_expansion(const Expansion& e, double b) {
+        Expansion result;
+        result.reserve(e.size() + 1);
+        double q = b;
+        for (double term : e) {
+            double error;
+            two_sum(q, term, q, error);
+            if (error != 0) result.push_back(error);
+        }
+        if (q != 0 || result.empty()) result.push_back(q);
+        return result;
+    }
+
+    Expansion expansion_sum(const Expansion& e, const Expansion& f) {
+        Expansion result = e;
+        for (double term : f) {
+            result = grow_expansion(result, term);
+        }
+        return result;
+    }
+
+    Expansion expansion_negate(Expansion e) {
+        for (double& term : e) {
+            term = -term;
+        }
+        return e;
+    }
+
+    Expansion expansion_product(const Expansion& e, const Expansion& f) {
+        Expansion result = {0};
+        for (double a : e) {
+            for (double b : f) {
+                double product = a * b;
+                result = grow_expansion(grow_expansion(result, std::fma(a, b, -product)), product);
+            }
+        }
+        return result;
+    }
+
+    int expansion_sign(const Expansion& e) {
+        return (e.back() > 0) - (e.back() < 0);
+    }
+
+    int orient2d_exact(double ax, double ay, double bx, double by, double cx, double cy) {
+        Expansion acx = exact_difference(ax, cx);
+        Expansion acy = exact_difference(ay, cy);
+        Expansion bcx = exact_difference(bx, cx);
+        Expansion bcy = exact_difference(by, cy);
+        return expansion_sign(expansion_sum(expansion_product(acx, bcy), expansion_negate(expansion_product(acy, bcx))));
+    }
+
+    // positive if a, b, c turn counterclockwise, negative if clockwise, zero if collinear
+    int orient2d(double ax, double ay, double bx, double by, double cx, double cy) {
+        double left = (ax - cx) * (by - cy);
+        double right = (ay - cy) * (bx - cx);
+        double det = left - right;
+        double sum;
+        if (left > 0) {
+            if (right <= 0) return (det > 0) - (det < 0);
+            sum = left + right;
+        } else if (left < 0) {
+            if (right >= 0) return (det > 0) - (det < 0);
+            sum = -left - right;
+        } else {
+            return (det > 0) - (det < 0);
+        }
+        double bound = orient_bound * sum;
+        if (det >= bound || -det >= bound) return (det > 0) - (det < 0);
+        return orient2d_exact(ax, ay, bx, by, cx, cy);
+    }
+
+    int cross2d_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+        Expansion abx = exact_difference(bx, ax);
+        Expansion aby = exact_difference(by, ay);
+        Expansion cdx = exact_difference(dx, cx);
+        Expansion cdy = exact_difference(dy, cy);
+        return expansion_sign(expansion_sum(expansion_product(abx, cdy), expansion_negate(expansion_product(aby, cdx))));
+    }
+
+    // sign of (b - a) x (d - c): positive if d - c points counterclockwise of b - a;
+    // orient2d with two separate differences, so the same error bound applies
+    int cross2d(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+        double left = (bx - ax) * (dy - cy);
+        double right = (by - ay) * (dx - cx);
+        double det = left - right;
+        double bound = orient_bound * (fabs(left) + fabs(right));
+        if (det > bound || -det > bound) return (det > 0) - (det < 0);
+        return cross2d_exact(ax, ay, bx, by, cx, cy, dx, dy);
+    }
+
+    int incircle_exact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+        Expansion adx = exact_difference(ax, dx);
+        Expansion ady = exact_difference(ay, dy);
+        Expansion bdx = exact_difference(bx, dx);
+        Expansion bdy = exact_difference(by, dy);
+        Expansion cdx = exact_difference(cx, dx);
+        Expansion cdy = exact_difference(cy, dy);
+        auto lift = [](const Expansion& x, const Expansion& y) {
+            return expansion_sum(expansion_product(x, x), expansion_product(y, y));
+        };
+        auto cross = [](const Expansion& x1, const Expansion& y1, const Expansion& x2, const Expansion& y2) {
+            return expansion_sum(expansion_product(x1, y2), expansion_negate(expansion_product(y1, x2)));
+        };
+        Expansion det = expansion_product(lift(adx, ady), cross(bdx, bdy, cdx, cdy));
+        det = expansion_sum(det, expansion_product(lift(bdx, bdy), cross(cdx, cdy, adx, ady)));
+        det = expansion_sum(det, expansion_product(lift(cdx, cdy), cross(adx, ady, bdx, bdy)));
+        return expansion_sign(det);
+    }
+
+    // positive if d lies inside the circle through a, b, c taken counterclockwise,
+    // negative if outside, zero if the four points are cocircular
+    int incircle(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+        double adx = ax - dx;
+        double ady = ay - dy;
+        double bdx = bx - dx;
+        double bdy = by - dy;
+        double cdx = cx - dx;
+        double cdy = cy - dy;
+        double bdxcdy = bdx * cdy;
+        double cdxbdy = cdx * bdy;
+        double cdxady = cdx * ady;
+        double adxcdy = adx * cdy;
+        double adxbdy = adx * bdy;
+        double bdxady = bdx * ady;
+        double alift = adx * adx + ady * ady;
+        double blift = bdx * bdx + bdy * bdy;
+        double clift = cdx * cdx + cdy * cdy;
+        double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+        double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift + (fabs(cdxady) + fabs(adxcdy)) * blift
+                         + (fabs(adxbdy) + fabs(bdxady)) * clift;
+        double bound = incircle_bound * permanent;
+        if (det > bound || -det > bound) return (det > 0) - (det < 0);
+        return incircle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+    }
+
+    // sign of (b - a) x (c - a); exact integer arithmetic for exact types (coordinates
+    // below 2^62 in absolute value), the adaptive predicate otherwise
+    template <typename T>
+    int orientation(const BasicPoint<T>& a, const BasicPoint<T>& b, const BasicPoint<T>& c) {
+        if constexpr (ScalarTraits<T>::exact) {
+            using Wide = typename ScalarTraits<T>::wide;
+            Wide cross = (Wide(b.x) - Wide(a.x)) * (Wide(c.y) - Wide(a.y)) - (Wide(b.y) - Wide(a.y)) * (Wide(c.x) - Wide(a.x));
+            return (cross > 0) - (cross < 0);
+        } else {
+            return orient2d(a.x, a.y, b.x, b.y, c.x, c.y);
+        }
+    }
+
+    template <typename T>
+    requires std::floating_point<T>
+    int incircle(const BasicPoint<T>& a, const BasicPoint<T>& b, const BasicPoint<T>& c, const BasicPoint<T>& d) {
+        return incircle(a.x, a.y, b.x, b.y, c.x, c.y, d.x, d.y);
+    }
+}
 
 /////////////////////////////////////////////////////////////////////////////////
 
-void Line::norm() {
-    double g = std::sqrt(a * a + b * b);
+template <typename T>
+void BasicLine<T>::norm() {
+    T g = std::sqrt(a * a + b * b);
     a /= g;
     b /= g;
     c /= g;
@@ -130,49 +455,818 @@ void Line::norm() {
     }
 }
 
-double Line::get_coef() const {
+template <typename T>
+T BasicLine<T>::get_coef() const {
     return -a / b;
 }
 
-Line::Line(const double& m, const double& dist): a(1), b(-a / m), c(dist * sqrt(a * a + b * b)) {}
+template <typename T>
+BasicLine<T>::BasicLine(const T& m, const T& dist): a(1), b(-a / m), c(dist * std::sqrt(a * a + b * b)) {}
 
-Line::Line(const Point& first, const Point& second) {
+template <typename T>
+BasicLine<T>::BasicLine(const Point& first, const Point& second) {
     a = second.y - first.y;
     b = first.x - second.x;
     c = second.x * first.y - second.y * first.x;
 }
 
-Point Line::operator*(const Line& other) const {
+// throws std::invalid_argument for parallel lines, which have no single common point
+template <typename T>
+BasicPoint<T> BasicLine<T>::operator*(const BasicLine& other) const {
+    T det = other.a * b - a * other.b;
+    if (det == T(0)) throw std::invalid_argument("Line::operator*: parallel lines");
     Point res;
-    res.y = (a * other.c - other.a * c) / (other.a * b - a * other.b);
-    res.x = -(b * other.c - other.b * c) / (other.a * b - a * other.b);
+    res.y = (a * other.c - other.a * c) / det;
+    res.x = -(b * other.c - other.b * c) / det;
     return res;
 }
 
-Line::Line(const Point& v, const double& m): a(-m), b(1), c(m * v.x - v.y) {}
+template <typename T>
+BasicLine<T>::BasicLine(const Point& v, const T& m): a(-m), b(1), c(m * v.x - v.y) {}
 
-double Line::dist(const Point& p) const {
-    return fabs(a * p.x + b * p.y + c) / sqrt(a * a + b * b);
+template <typename T>
+typename ScalarTraits<T>::real BasicLine<T>::dist(const Point& p) const {
+    using Real = typename ScalarTraits<T>::real;
+    return std::fabs(Real(a * p.x + b * p.y + c)) / std::sqrt(Real(a * a + b * b));
 }
 
-Line Line::perp(const Point& v) const {
-    Line res;
+template <typename T>
+BasicLine<T> BasicLine<T>::perp(const Point& v) const {
+    BasicLine res;
     res.a = -b;
     res.b = a;
     res.c = -(v.x * res.a + v.y * res.b);
     return res;
 }
 
-bool Line::operator==(const Line& other) const {
-    Line first = *this;
-    Line second = other;
-    first.norm();
-    second.norm();
-    return Geometry::equal(first.a, second.a, eps) && Geometry::equal(first.b, second.b, eps)
-            && Geometry::equal(first.c, second.c, eps);
+// integer lines are equal when their coefficients are proportional
+template <typename T>
+bool BasicLine<T>::operator==(const BasicLine& other) const {
+    if constexpr (ScalarTraits<T>::exact) {
+        using Wide = typename ScalarTraits<T>::wide;
+        return Wide(a) * other.b == Wide(b) * other.a && Wide(a) * other.c == Wide(c) * other.a
+            && Wide(b) * other.c == Wide(c) * other.b;
+    } else {
+        BasicLine first = *this;
+        BasicLine second = other;
+        first.norm();
+        second.norm();
+        return Geometry::equal(first.a, second.a, eps) && Geometry::equal(first.b, second.b, eps)
+                && Geometry::equal(first.c, second.c, eps);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// x' = a * x + b * y + e
+// y' = c * x + d * y + f
+class AffineTransform {
+public:
+    AffineTransform(): a(1), b(0), c(0), d(1), e(0), f(0) {}
+
+    AffineTransform(double a, double b, double c, double d, double e, double f);
+
+    static AffineTransform rotation(const Point& center, double angle);
+
+    static AffineTransform reflection(const Point& center);
+
+    static AffineTransform reflection(const Line& axis);
+
+    static AffineTransform scaling(const Point& center, double coefficient);
+
+    // (first * second)(p) == first(second(p))
+    AffineTransform operator*(const AffineTransform& other) const;
+
+    AffineTransform& rotate(const Point& center, double angle);
+
+    AffineTransform& reflect(const Point& center);
+
+    AffineTransform& reflect(const Line& axis);
+
+    AffineTransform& scale(const Point& center, double coefficient);
+
+    Point operator()(const Point& p) const;
+
+    double determinant() const;
+
+    bool isSimilarity() const;
+
+    double similarityRatio() const;
+
+    double a;
+    double b;
+    double c;
+    double d;
+    double e;
+    double f;
+
+    static const constexpr double pi = 3.141592653589793238;
+    static const constexpr double eps = 1e-9;
+};
+
+AffineTransform::AffineTransform(double a, double b, double c, double d, double e, double f)
+        : a(a), b(b), c(c), d(d), e(e), f(f) {}
+
+AffineTransform AffineTransform::rotation(const Point& center, double angle) {
+    angle /= 180 / pi;
+    double cs = cos(angle);
+    double sn = sin(angle);
+    return {cs, -sn, sn, cs, center.x - cs * center.x + sn * center.y, center.y - sn * center.x - cs * center.y};
+}
+
+AffineTransform AffineTransform::reflection(const Point& center) {
+    return {-1, 0, 0, -1, 2 * center.x, 2 * center.y};
+}
+
+AffineTransform AffineTransform::reflection(const Line& axis) {
+    double n = axis.a * axis.a + axis.b * axis.b;
+    double ka = 2 * axis.a / n;
+    double kb = 2 * axis.b / n;
+    return {1 - ka * axis.a, -ka * axis.b, -kb * axis.a, 1 - kb * axis.b, -ka * axis.c, -kb * axis.c};
+}
+
+AffineTransform AffineTransform::scaling(const Point& center, double coefficient) {
+    return {coefficient, 0, 0, coefficient, center.x * (1 - coefficient), center.y * (1 - coefficient)};
+}
+
+AffineTransform AffineTransform::operator*(const AffineTransform& other) const {
+    return {a * other.a + b * other.c, a * other.b + b * other.d,
+            c * other.a + d * other.c, c * other.b + d * other.d,
+            a * other.e + b * other.f + e, c * other.e + d * other.f + f};
+}
+
+AffineTransform& AffineTransform::rotate(const Point& center, double angle) {
+    return *this = rotation(center, angle) * *this;
+}
+
+AffineTransform& AffineTransform::reflect(const Point& center) {
+    return *this = reflection(center) * *this;
+}
+
+AffineTransform& AffineTransform::reflect(const Line& axis) {
+    return *this = reflection(axis) * *this;
+}
+
+AffineTransform& AffineTransform::scale(const Point& center, double coefficient) {
+    return *this = scaling(center, coefficient) * *this;
+}
+
+Point AffineTransform::operator()(const Point& p) const {
+    return {a * p.x + b * p.y + e, c * p.x + d * p.y + f};
+}
+
+double AffineTransform::determinant() const {
+    return a * d - b * c;
+}
+
+bool AffineTransform::isSimilarity() const {
+    double norm = a * a + b * b + c * c + d * d;
+    return fabs(a * b + c * d) <= eps * norm && fabs(a * a + c * c - b * b - d * d) <= eps * norm;
+}
+
+double AffineTransform::similarityRatio() const {
+    return sqrt(fabs(determinant()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+struct BoundingBox {
+    Point lower;
+    Point upper;
+
+    BoundingBox(): lower(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity())
+            , upper(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()) {}
+
+    BoundingBox(const Point& lower_, const Point& upper_): lower(lower_), upper(upper_) {}
+
+    bool empty() const {
+        return lower.x > upper.x || lower.y > upper.y;
+    }
+
+    void extend(const Point& p) {
+        lower = {std::min(lower.x, p.x), std::min(lower.y, p.y)};
+        upper = {std::max(upper.x, p.x), std::max(upper.y, p.y)};
+    }
+
+    void extend(const BoundingBox& other) {
+        lower = {std::min(lower.x, other.lower.x), std::min(lower.y, other.lower.y)};
+        upper = {std::max(upper.x, other.upper.x), std::max(upper.y, other.upper.y)};
+    }
+
+    Point center() const {
+        return (lower + upper) / 2;
+    }
+
+    bool containsPoint(const Point& p) const {
+        return lower.x <= p.x && p.x <= upper.x && lower.y <= p.y && p.y <= upper.y;
+    }
+
+    bool intersects(const BoundingBox& other) const {
+        return lower.x <= other.upper.x && other.lower.x <= upper.x
+            && lower.y <= other.upper.y && other.lower.y <= upper.y;
+    }
+
+    double distance(const Point& p) const {
+        double dx = std::max({lower.x - p.x, 0.0, p.x - upper.x});
+        double dy = std::max({lower.y - p.y, 0.0, p.y - upper.y});
+        return sqrt(dx * dx + dy * dy);
+    }
+};
+
+struct BoundingCircle {
+    Point center;
+    double radius = -std::numeric_limits<double>::infinity();
+
+    BoundingCircle() = default;
+
+    BoundingCircle(const Point& center_, double radius_): center(center_), radius(radius_) {}
+
+    bool containsPoint(const Point& p) const {
+        double dx = p.x - center.x;
+        double dy = p.y - center.y;
+        return radius >= 0 && dx * dx + dy * dy <= radius * radius;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////
+// algorithms on a closed vertex sequence shared by Polygon and views of external storage
+namespace Geometry {
+    double polygon_area(std::span<const Point> v) {
+        double result = 0;
+        for (size_t i = 2; i < v.size(); ++i) {
+            result += (v[i] - v[0]).crossProduct(v[i - 1] - v[0]);
+        }
+        return fabs(result) / 2;
+    }
+
+    double polygon_perimeter(std::span<const Point> v) {
+        if (v.empty()) return 0;
+        double result = 0;
+        for (size_t i = 1; i < v.size(); ++i) {
+            result += (v[i] - v[i - 1]).len();
+        }
+        return result + (v.back() - v[0]).len();
+    }
+
+    bool polygon_convex(std::span<const Point> v) {
+        int cnt_left = 0, cnt_right = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            const Point& prev = v[i == 0 ? v.size() - 1 : i - 1];
+            const Point& next = v[i + 1 == v.size() ? 0 : i + 1];
+            if (orientation(prev, v[i], next) > 0) {
+                ++cnt_left;
+            } else {
+                ++cnt_right;
+            }
+        }
+        return cnt_right == 0 || cnt_left == 0;
+    }
+
+    // winding number with exact crossing decisions; points within eps of the boundary are inside
+    bool polygon_contains(std::span<const Point> v, const Point& point) {
+        int winding = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            const Point& cur = v[i];
+            const Point& next = v[i + 1 == v.size() ? 0 : i + 1];
+            double cross = (cur - point).crossProduct(next - point);
+            if (fabs(cross) < ScalarTraits<double>::shape_eps && (cur - point).dotProduct(next - point) <= 0) return true;
+            if (cur.y <= point.y) {
+                if (next.y > point.y && orientation(point, cur, next) > 0) ++winding;
+            } else if (next.y <= point.y && orientation(point, cur, next) < 0) {
+                --winding;
+            }
+        }
+        return winding != 0;
+    }
+
+    // p comes before q in the sweep: higher, or as high and further left
+    bool sweep_above(const Point& p, const Point& q) {
+        return p.y > q.y || (p.y == q.y && p.x < q.x);
+    }
+
+    void emit_triangle(std::span<const Point> v, size_t a, size_t b, size_t c, std::vector<std::array<size_t, 3>>& triangles) {
+        if (orientation(v[a], v[b], v[c]) < 0) std::swap(b, c);
+        triangles.push_back({a, b, c});
+    }
+
+    // v is counterclockwise; O(n^3), for small polygons only
+    bool ear_clipping(std::span<const Point> v, std::vector<std::array<size_t, 3>>& triangles) {
+        std::vector<size_t> remaining(v.size());
+        std::iota(remaining.begin(), remaining.end(), 0);
+        while (remaining.size() > 3) {
+            size_t m = remaining.size();
+            bool clipped = false;
+            for (size_t k = 0; k < m && !clipped; ++k) {
+                size_t a = remaining[(k + m - 1) % m];
+                size_t b = remaining[k];
+                size_t c = remaining[(k + 1) % m];
+                if (orientation(v[a], v[b], v[c]) <= 0) continue;
+                bool ear = true;
+                for (size_t r : remaining) {
+                    if (r == a || r == b || r == c) continue;
+                    if (orientation(v[a], v[b], v[r]) >= 0 && orientation(v[b], v[c], v[r]) >= 0
+                        && orientation(v[c], v[a], v[r]) >= 0) {
+                        ear = false;
+                        break;
+                    }
+                }
+                if (ear) {
+                    emit_triangle(v, a, b, c, triangles);
+                    remaining.erase(remaining.begin() + k);
+                    clipped = true;
+                }
+            }
+            if (!clipped) return false;
+        }
+        emit_triangle(v, remaining[0], remaining[1], remaining[2], triangles);
+        return true;
+    }
+
+    // piece is a counterclockwise y-monotone polygon given by indices into v
+    void triangulate_monotone(std::span<const Point> v, const std::vector<size_t>& piece,
+                              std::vector<std::array<size_t, 3>>& triangles) {
+        size_t k = piece.size();
+        if (k < 3) return;
+        size_t top = 0;
+        size_t bottom = 0;
+        for (size_t i = 1; i < k; ++i) {
+            if (sweep_above(v[piece[i]], v[piece[top]])) top = i;
+            if (sweep_above(v[piece[bottom]], v[piece[i]])) bottom = i;
+        }
+        // merge the left chain (counterclockwise from the top) and the right chain into sweep order
+        std::vector<std::pair<size_t, bool>> order;
+        order.reserve(k);
+        order.push_back({piece[top], true});
+        size_t left = (top + 1) % k;
+        size_t right = (top + k - 1) % k;
+        while (left != bottom || right != bottom) {
+            if (right == bottom || (left != bottom && sweep_above(v[piece[left]], v[piece[right]]))) {
+                order.push_back({piece[left], true});
+                left = (left + 1) % k;
+            } else {
+                order.push_back({piece[right], false});
+                right = (right + k - 1) % k;
+            }
+        }
+        order.push_back({piece[bottom], true});
+        std::vector<std::pair<size_t, bool>> stack = {order[0], order[1]};
+        for (size_t j = 2; j + 1 < k; ++j) {
+            if (order[j].second != stack.back().second) {
+                for (size_t i = 0; i + 1 < stack.size(); ++i) {
+                    emit_triangle(v, order[j].first, stack[i].first, stack[i + 1].first, triangles);
+                }
+                stack = {order[j - 1], order[j]};
+            } else {
+                std::pair<size_t, bool> last = stack.back();
+                stack.pop_back();
+                while (!stack.empty()) {
+                    int turn = orientation(v[stack.back().first], v[last.first], v[order[j].first]);
+                    if (order[j].second ? turn <= 0 : turn >= 0) break;
+                    emit_triangle(v, order[j].first, last.first, stack.back().first, triangles);
+                    last = stack.back();
+                    stack.pop_back();
+                }
+                stack.push_back(last);
+                stack.push_back(order[j]);
+            }
+        }
+        for (size_t i = 0; i + 1 < stack.size(); ++i) {
+            emit_triangle(v, order[k - 1].first, stack[i].first, stack[i + 1].first, triangles);
+        }
+    }
+
+    // v is counterclockwise. Sweeps top to bottom adding diagonals at split and merge vertices,
+    // then walks the faces of the subdivision and triangulates each monotone piece. O(n log n).
+    bool monotone_triangulation(std::span<const Point> v, std::vector<std::array<size_t, 3>>& triangles) {
+        enum class Kind { Start, End, Split, Merge, Regular };
+        size_t n = v.size();
+        auto prev = [n](size_t i) { return i == 0 ? n - 1 : i - 1; };
+        auto next = [n](size_t i) { return i + 1 == n ? 0 : i + 1; };
+        std::vector<Kind> kind(n);
+        for (size_t i = 0; i < n; ++i) {
+            bool prev_below = sweep_above(v[i], v[prev(i)]);
+            bool next_below = sweep_above(v[i], v[next(i)]);
+            bool convex = orientation(v[prev(i)], v[i], v[next(i)]) > 0;
+            if (prev_below && next_below) {
+                kind[i] = convex ? Kind::Start : Kind::Split;
+            } else if (!prev_below && !next_below) {
+                kind[i] = convex ? Kind::End : Kind::Merge;
+            } else {
+                kind[i] = Kind::Regular;
+            }
+        }
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return sweep_above(v[lhs], v[rhs]); });
+
+        // edges i -> next(i) with the interior on their right, keyed by their upper vertex i;
+        // the later of two edges is compared through its upper vertex, so a vertex index
+        // also works as a probe for the edges left of it
+        auto less = [&](size_t lhs, size_t rhs) {
+            if (sweep_above(v[lhs], v[rhs])) return orientation(v[lhs], v[next(lhs)], v[rhs]) > 0;
+            return orientation(v[rhs], v[next(rhs)], v[lhs]) < 0;
+        };
+        std::set<size_t, decltype(less)> status(less);
+        std::vector<std::set<size_t, decltype(less)>::iterator> position(n, status.end());
+        std::vector<size_t> helper(n);
+        std::vector<std::pair<size_t, size_t>> diagonals;
+        auto insert = [&](size_t i) {
+            position[i] = status.insert(i).first;
+            helper[i] = i;
+        };
+        auto finish = [&](size_t i, size_t edge) {
+            if (position[edge] == status.end()) return false;
+            if (kind[helper[edge]] == Kind::Merge) diagonals.push_back({i, helper[edge]});
+            status.erase(position[edge]);
+            position[edge] = status.end();
+            return true;
+        };
+        auto left_of = [&](size_t i) {
+            auto it = status.lower_bound(i);
+            return it == status.begin() ? n : *std::prev(it);
+        };
+        for (size_t i : order) {
+            if (kind[i] == Kind::Start) {
+                insert(i);
+            } else if (kind[i] == Kind::End) {
+                if (!finish(i, prev(i))) return false;
+            } else if (kind[i] == Kind::Split) {
+                size_t edge = left_of(i);
+                if (edge == n) return false;
+                diagonals.push_back({i, helper[edge]});
+                helper[edge] = i;
+                insert(i);
+            } else if (kind[i] == Kind::Merge || !sweep_above(v[prev(i)], v[i])) {
+                if (kind[i] == Kind::Merge && !finish(i, prev(i))) return false;
+                size_t edge = left_of(i);
+                if (edge == n) return false;
+                if (kind[helper[edge]] == Kind::Merge) diagonals.push_back({i, helper[edge]});
+                helper[edge] = i;
+            } else {
+                if (!finish(i, prev(i))) return false;
+                insert(i);
+            }
+        }
+
+        // neighbours of every vertex in counterclockwise order; walking a face turns to the
+        // neighbour clockwise from the one we came from, which keeps the face on the left
+        std::vector<size_t> first(n + 1, 2);
+        for (const auto& [a, b] : diagonals) {
+            ++first[a];
+            ++first[b];
+        }
+        first[n] = 0;
+        std::exclusive_scan(first.begin(), first.end(), first.begin(), size_t(0));
+        std::vector<size_t> neighbours(first[n]);
+        std::vector<size_t> filled(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            neighbours[filled[i]++] = prev(i);
+            neighbours[filled[i]++] = next(i);
+        }
+        for (const auto& [a, b] : diagonals) {
+            neighbours[filled[a]++] = b;
+            neighbours[filled[b]++] = a;
+        }
+        auto around = [&](size_t center) {
+            return [&, center](size_t lhs, size_t rhs) {
+                Point l = v[lhs] - v[center];
+                Point r = v[rhs] - v[center];
+                bool l_lower = l.y < 0 || (l.y == 0 && l.x < 0);
+                bool r_lower = r.y < 0 || (r.y == 0 && r.x < 0);
+                if (l_lower != r_lower) return r_lower;
+                return orientation(v[center], v[lhs], v[rhs]) > 0;
+            };
+        };
+        for (size_t i = 0; i < n; ++i) {
+            if (first[i + 1] - first[i] > 2) {
+                std::sort(neighbours.begin() + first[i], neighbours.begin() + first[i + 1], around(i));
+            }
+        }
+        auto slot = [&](size_t from, size_t to) {
+            auto begin = neighbours.begin() + first[from];
+            auto end = neighbours.begin() + first[from + 1];
+            auto it = end - begin == 2 ? (*begin == to ? begin : begin + 1) : std::lower_bound(begin, end, to, around(from));
+            return static_cast<size_t>(it - neighbours.begin());
+        };
+        std::vector<bool> used(neighbours.size());
+        std::vector<size_t> piece;
+        auto walk = [&](size_t from, size_t to) {
+            piece.clear();
+            while (!used[slot(from, to)]) {
+                used[slot(from, to)] = true;
+                piece.push_back(from);
+                size_t back = slot(to, from) - first[to];
+                size_t degree = first[to + 1] - first[to];
+                from = std::exchange(to, neighbours[first[to] + (back + degree - 1) % degree]);
+            }
+            triangulate_monotone(v, piece, triangles);
+        };
+        for (size_t i = 0; i < n; ++i) {
+            walk(i, next(i));
+        }
+        for (const auto& [a, b] : diagonals) {
+            walk(a, b);
+            walk(b, a);
+        }
+        return true;
+    }
+
+    // triangles over vertex indices with the orientation of the polygon, nullopt if the
+    // polygon is not simple
+    std::optional<std::vector<std::array<size_t, 3>>> triangulate(std::span<const Point> polygon) {
+        static const size_t ear_clipping_limit = 32;
+        size_t n = polygon.size();
+        std::vector<std::array<size_t, 3>> triangles;
+        if (n < 3) return triangles;
+        double doubled_area = 0;
+        for (size_t i = 0; i < n; ++i) {
+            doubled_area += polygon[i].crossProduct(polygon[i + 1 == n ? 0 : i + 1]);
+        }
+        bool clockwise = doubled_area < 0;
+        std::vector<Point> v(polygon.begin(), polygon.end());
+        if (clockwise) std::reverse(v.begin(), v.end());
+        triangles.reserve(n - 2);
+        if (n > ear_clipping_limit || !ear_clipping(v, triangles)) {
+            triangles.clear();
+            if (!monotone_triangulation(v, triangles)) return std::nullopt;
+        }
+        double covered = 0;
+        for (const auto& triangle : triangles) {
+            covered += (v[triangle[1]] - v[triangle[0]]).crossProduct(v[triangle[2]] - v[triangle[0]]);
+        }
+        if (clockwise) {
+            for (auto& triangle : triangles) {
+                triangle = {n - 1 - triangle[0], n - 1 - triangle[2], n - 1 - triangle[1]};
+            }
+        }
+        if (triangles.size() != n - 2 || fabs(covered - fabs(doubled_area)) > ScalarTraits<double>::shape_eps * std::max(1.0, fabs(doubled_area))) {
+            return std::nullopt;
+        }
+        return triangles;
+    }
+
+    double segment_distance(const Point& p, const Point& a, const Point& b) {
+        Point ab = b - a;
+        double length = ab.dotProduct(ab);
+        double t = length == 0 ? 0 : std::clamp((p - a).dotProduct(ab) / length, 0.0, 1.0);
+        return (a + ab * t - p).len();
+    }
+
+    // closed segments, touching counts
+    bool segments_intersect(const Point& a, const Point& b, const Point& c, const Point& d) {
+        int abc = orientation(a, b, c);
+        int abd = orientation(a, b, d);
+        int cda = orientation(c, d, a);
+        int cdb = orientation(c, d, b);
+        if (abc * abd < 0 && cda * cdb < 0) return true;
+        auto on = [](const Point& p, const Point& q, const Point& r) {
+            return std::min(p.x, q.x) <= r.x && r.x <= std::max(p.x, q.x)
+                && std::min(p.y, q.y) <= r.y && r.y <= std::max(p.y, q.y);
+        };
+        return (abc == 0 && on(a, b, c)) || (abd == 0 && on(a, b, d))
+            || (cda == 0 && on(c, d, a)) || (cdb == 0 && on(c, d, b));
+    }
+
+    // Douglas-Peucker on the ring, split at vertex 0 and the vertex farthest from it;
+    // keeps every vertex farther than tolerance from the shortcut that would replace it
+    std::vector<char> douglas_peucker(std::span<const Point> v, double tolerance) {
+        size_t n = v.size();
+        std::vector<char> keep(n, n <= 3);
+        if (n <= 3) return keep;
+        size_t far = 0;
+        for (size_t i = 1; i < n; ++i) {
+            if ((v[i] - v[0]).len() > (v[far] - v[0]).len()) far = i;
+        }
+        keep[0] = keep[far] = true;
+        // ranges over the doubled ring, so that the second half wraps around vertex 0
+        std::vector<std::pair<size_t, size_t>> stack = {{0, far}, {far, n}};
+        size_t kept = 2;
+        std::pair<double, size_t> widest = {-1, 0};
+        while (!stack.empty()) {
+            auto [first, last] = stack.back();
+            stack.pop_back();
+            double distance = -1;
+            size_t split = first;
+            for (size_t i = first + 1; i < last; ++i) {
+                double d = segment_distance(v[i % n], v[first % n], v[last % n]);
+                if (d > distance) {
+                    distance = d;
+                    split = i;
+                }
+            }
+            if (split == first) continue;
+            widest = std::max(widest, {distance, split % n});
+            if (distance <= tolerance) continue;
+            keep[split % n] = true;
+            ++kept;
+            stack.push_back({first, split});
+            stack.push_back({split, last});
+        }
+        if (kept < 3) keep[widest.second] = true;
+        return keep;
+    }
+
+    // Visvalingam-Whyatt: drops the vertex spanning the smallest triangle with its neighbours
+    // while that area is below tolerance. A heap with stale entries skipped, O(n log n).
+    std::vector<char> visvalingam_whyatt(std::span<const Point> v, double tolerance) {
+        size_t n = v.size();
+        std::vector<char> keep(n, true);
+        if (n <= 3) return keep;
+        std::vector<size_t> prev(n), next(n);
+        std::vector<double> area(n);
+        for (size_t i = 0; i < n; ++i) {
+            prev[i] = i == 0 ? n - 1 : i - 1;
+            next[i] = i + 1 == n ? 0 : i + 1;
+        }
+        auto triangle = [&](size_t i) { return fabs((v[prev[i]] - v[i]).crossProduct(v[next[i]] - v[i])) / 2; };
+        // vertices at or above tolerance can never go, so they stay out of the heap
+        using Entry = std::pair<double, size_t>;
+        std::vector<Entry> candidates;
+        for (size_t i = 0; i < n; ++i) {
+            area[i] = triangle(i);
+            if (area[i] < tolerance) candidates.push_back({area[i], i});
+        }
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap(std::greater<>(), std::move(candidates));
+        size_t remaining = n;
+        while (remaining > 3 && !heap.empty()) {
+            auto [smallest, i] = heap.top();
+            heap.pop();
+            if (!keep[i] || smallest != area[i]) continue;
+            keep[i] = false;
+            --remaining;
+            next[prev[i]] = next[i];
+            prev[next[i]] = prev[i];
+            // a neighbour never gets a smaller area than the vertex removed before it
+            for (size_t j : {prev[i], next[i]}) {
+                area[j] = std::max(triangle(j), smallest);
+                if (area[j] < tolerance) heap.push({area[j], j});
+            }
+        }
+        return keep;
+    }
+
+    // Brings back dropped vertices until no shortcut crosses another one and, with convexity,
+    // every kept vertex turns the way it did in v. A shortcut in violation gets the dropped
+    // vertex farthest from it; v itself is the fixed point, so this ends.
+    void repair_simplification(std::span<const Point> v, std::vector<char>& keep, bool topology, bool convexity) {
+        size_t n = v.size();
+        while (true) {
+            std::vector<size_t> kept;
+            for (size_t i = 0; i < n; ++i) {
+                if (keep[i]) kept.push_back(i);
+            }
+            size_t m = kept.size();
+            if (m < 3) return;
+            auto end = [&](size_t s) { return kept[s + 1 == m ? 0 : s + 1]; };
+            std::vector<char> bad(m, false);
+            if (topology) {
+                // shortcuts bucketed by the grid cells they pass through, column by column
+                BoundingBox box;
+                for (size_t i : kept) {
+                    box.extend(v[i]);
+                }
+                size_t side = std::max<size_t>(1, static_cast<size_t>(sqrt(static_cast<double>(m))));
+                double width = std::max(box.upper.x - box.lower.x, box.upper.y - box.lower.y) / side;
+                auto cell = [&](double value, double lower) {
+                    if (!(width > 0)) return size_t(0);
+                    return std::min(side - 1, static_cast<size_t>(std::max(0.0, (value - lower) / width)));
+                };
+                std::vector<std::vector<size_t>> cells(side * side);
+                for (size_t s = 0; s < m; ++s) {
+                    Point a = v[kept[s]];
+                    Point b = v[end(s)];
+                    if (b.x < a.x) std::swap(a, b);
+                    double slope = b.x > a.x ? (b.y - a.y) / (b.x - a.x) : 0;
+                    // the y range within a column is widened a little against rounding
+                    double slack = width * 1e-9;
+                    for (size_t x = cell(a.x, box.lower.x); x <= cell(b.x, box.lower.x); ++x) {
+                        double from = std::max(a.x, box.lower.x + x * width);
+                        double to = std::min(b.x, box.lower.x + (x + 1) * width);
+                        double y0 = b.x > a.x ? a.y + (from - a.x) * slope : a.y;
+                        double y1 = b.x > a.x ? a.y + (to - a.x) * slope : b.y;
+                        size_t high = cell(std::max(y0, y1) + slack, box.lower.y);
+                        for (size_t y = cell(std::min(y0, y1) - slack, box.lower.y); y <= high; ++y) {
+                            cells[x * side + y].push_back(s);
+                        }
+                    }
+                }
+                auto segment_box = [&](size_t s) {
+                    BoundingBox result;
+                    result.extend(v[kept[s]]);
+                    result.extend(v[end(s)]);
+                    return result;
+                };
+                for (const std::vector<size_t>& segments : cells) {
+                    for (size_t i = 0; i < segments.size(); ++i) {
+                        for (size_t j = i + 1; j < segments.size(); ++j) {
+                            size_t s = segments[i];
+                            size_t t = segments[j];
+                            if (t == s + 1 || (s == 0 && t == m - 1)) continue;
+                            if ((bad[s] && bad[t]) || !segment_box(s).intersects(segment_box(t))) continue;
+                            if (segments_intersect(v[kept[s]], v[end(s)], v[kept[t]], v[end(t)])) {
+                                bad[s] = bad[t] = true;
+                            }
+                        }
+                    }
+                }
+            }
+            if (convexity) {
+                for (size_t s = 0; s < m; ++s) {
+                    size_t i = kept[s];
+                    size_t before = kept[s == 0 ? m - 1 : s - 1];
+                    int original = orientation(v[i == 0 ? n - 1 : i - 1], v[i], v[i + 1 == n ? 0 : i + 1]);
+                    if (orientation(v[before], v[i], v[end(s)]) != original) {
+                        bad[s == 0 ? m - 1 : s - 1] = bad[s] = true;
+                    }
+                }
+            }
+            bool restored = false;
+            for (size_t s = 0; s < m; ++s) {
+                if (!bad[s]) continue;
+                size_t first = kept[s];
+                size_t last = end(s);
+                double distance = -1;
+                size_t farthest = first;
+                for (size_t i = first + 1 == n ? 0 : first + 1; i != last; i = i + 1 == n ? 0 : i + 1) {
+                    double d = segment_distance(v[i], v[first], v[last]);
+                    if (d > distance) {
+                        distance = d;
+                        farthest = i;
+                    }
+                }
+                if (farthest != first) {
+                    keep[farthest] = true;
+                    restored = true;
+                }
+            }
+            if (!restored) return;
+        }
+    }
+
+    // Welzl's algorithm, iterative over a shuffled copy, expected O(n). Membership is tested
+    // with a relative slack, so that cocircular vertices do not keep replacing the circle; the
+    // radius is then widened until BoundingCircle::containsPoint accepts every point.
+    BoundingCircle enclosing_circle(std::span<const Point> v) {
+        static const constexpr double slack = 1e-12;
+        if (v.empty()) return BoundingCircle();
+        std::vector<Point> p(v.begin(), v.end());
+        std::shuffle(p.begin(), p.end(), std::minstd_rand(static_cast<unsigned>(p.size())));
+        Point center = p[0];
+        double squared = 0;
+        auto inside = [&](const Point& q) {
+            double dx = q.x - center.x;
+            double dy = q.y - center.y;
+            return dx * dx + dy * dy <= squared * (1 + slack);
+        };
+        auto diametral = [&](const Point& a, const Point& b) {
+            center = (a + b) / 2;
+            squared = (a - center).dotProduct(a - center);
+        };
+        for (size_t i = 1; i < p.size(); ++i) {
+            if (inside(p[i])) continue;
+            center = p[i];
+            squared = 0;
+            for (size_t j = 0; j < i; ++j) {
+                if (inside(p[j])) continue;
+                diametral(p[i], p[j]);
+                for (size_t l = 0; l < j; ++l) {
+                    if (inside(p[l])) continue;
+                    Point b = p[j] - p[i];
+                    Point c = p[l] - p[i];
+                    double d = 2 * b.crossProduct(c);
+                    if (orientation(p[i], p[j], p[l]) == 0 || d == 0) {
+                        // collinear, so the farthest pair spans the three
+                        const Point* ends[2] = {&p[i], &p[j]};
+                        if ((p[l] - p[i]).len() > (*ends[1] - *ends[0]).len()) ends[1] = &p[l];
+                        if ((p[l] - p[j]).len() > (*ends[1] - *ends[0]).len()) ends[0] = &p[j];
+                        diametral(*ends[0], *ends[1]);
+                        continue;
+                    }
+                    double bb = b.dotProduct(b);
+                    double cc = c.dotProduct(c);
+                    Point offset = Point(c.y * bb - b.y * cc, b.x * cc - c.x * bb) / d;
+                    center = p[i] + offset;
+                    squared = offset.dotProduct(offset);
+                }
+            }
+        }
+        double farthest = 0;
+        for (const Point& q : v) {
+            double dx = q.x - center.x;
+            double dy = q.y - center.y;
+            farthest = std::max(farthest, dx * dx + dy * dy);
+        }
+        double radius = sqrt(farthest);
+        while (radius * radius < farthest) {
+            radius = std::nextafter(radius, std::numeric_limits<double>::infinity());
+        }
+        return {center, radius};
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
+// Derived quantities are cached on first use, so const member functions may write the
+// cache and are not safe to call on one shape from several threads at once. After
+// precompute() they only read until the shape is modified again; parallel code that
+// shares shapes between threads calls it first.
 class Shape {
 public:
     Shape() = default;
@@ -189,6 +1283,13 @@ public:
 
     virtual bool containsPoint(const Point& point) const = 0;
 
+    virtual BoundingBox boundingBox() const = 0;
+
+    // the smallest circle containing the shape
+    virtual BoundingCircle boundingCircle() const = 0;
+
+    virtual Point centroid() const = 0;
+
     virtual void rotate(const Point& center, double angle) = 0;
 
     virtual void reflect(const Point& center) = 0;
@@ -197,11 +1298,60 @@ public:
 
     virtual void scale(const Point& center, double coefficient) = 0;
 
+    virtual void apply(const AffineTransform& transform) = 0;
+
+    // fills every cache the const member functions would fill
+    virtual void precompute() const;
+
     virtual ~Shape() = default;
 
     static const constexpr double pi = 3.141592653589793238;
-    static const constexpr double eps = 1e-7;
+    static const constexpr double eps = ScalarTraits<double>::shape_eps;
+
+protected:
+    mutable std::optional<double> area_;
+    mutable std::optional<double> perimeter_;
+    mutable std::optional<BoundingBox> bounding_box_;
+    mutable std::optional<BoundingCircle> bounding_circle_;
+    mutable std::optional<Point> centroid_;
+
+    void transform_cache(const AffineTransform& transform);
 };
+
+void Shape::precompute() const {
+    area();
+    perimeter();
+    boundingBox();
+    boundingCircle();
+    centroid();
+}
+
+void Shape::transform_cache(const AffineTransform& transform) {
+    if (area_) {
+        *area_ *= fabs(transform.determinant());
+    }
+    if (perimeter_ && transform.isSimilarity()) {
+        *perimeter_ *= transform.similarityRatio();
+    } else {
+        perimeter_.reset();
+    }
+    if (centroid_) {
+        centroid_ = transform(*centroid_);
+    }
+    if (bounding_box_ && ((transform.b == 0 && transform.c == 0) || (transform.a == 0 && transform.d == 0))) {
+        BoundingBox box;
+        box.extend(transform(bounding_box_->lower));
+        box.extend(transform(bounding_box_->upper));
+        bounding_box_ = box;
+    } else {
+        bounding_box_.reset();
+    }
+    if (bounding_circle_ && transform.isSimilarity()) {
+        bounding_circle_ = BoundingCircle(transform(bounding_circle_->center), bounding_circle_->radius * transform.similarityRatio());
+    } else {
+        bounding_circle_.reset();
+    }
+}
 ////////////////////////////////////////////////////////////////////////
 
 class Ellipse : public Shape {
@@ -218,8 +1368,18 @@ public:
 
     Point center() const;
 
+    std::pair<double, double> semiAxes() const;
+
     bool containsPoint(const Point& point) const override;
 
+    std::vector<bool> containsPoints(std::span<const Point> query) const;
+
+    BoundingBox boundingBox() const override;
+
+    BoundingCircle boundingCircle() const override;
+
+    Point centroid() const override;
+
     void reflect(const Point& center) override;
 
     void reflect(const Line& axis) override;
@@ -228,12 +1388,18 @@ public:
 
     void scale(const Point& center, double coefficient) override;
 
+    void apply(const AffineTransform& transform) override;
+
     bool operator==(const Shape& other) const override;
 
     virtual bool isCongruentTo(const Shape& another) const override;
 
     bool isSimilarTo(const Shape& another) const override;
 
+    bool isCongruentTo(const Ellipse& another) const;
+
+    bool isSimilarTo(const Ellipse& another) const;
+
     ~Ellipse() override = default;
 
     double area() const override;
@@ -245,21 +1411,57 @@ protected:
     Point second_focus;
     double long_axis;
     double eccentricity_;
+
+    // Canonical frame derived from the foci and long_axis. The quadratic form belongs to the
+    // confocal ellipse with long axis long_axis + eps / 2: (p - center)^T Q (p - center) <= 1
+    // is then exactly the focal-distance test |p - F1| + |p - F2| <= 2 * long_axis + eps.
+    struct Frame {
+        Point center;
+        Point axis;
+        double long_axis;
+        double short_axis;
+        double xx, xy, yy;
+    };
+
+    Frame frame;
+
+    void update_frame();
 };
 
 Ellipse::Ellipse(const Point& ff, const Point& sf, double sum): first_focus(ff), second_focus(sf)
-        , long_axis(sum / 2), eccentricity_((ff - sf).len() / sum) {}
+        , long_axis(sum / 2), eccentricity_((ff - sf).len() / sum) {
+    update_frame();
+}
+
+void Ellipse::update_frame() {
+    double focus_dist = (second_focus - first_focus).len() / 2;
+    frame.center = (first_focus + second_focus) / 2;
+    frame.axis = focus_dist < eps ? Point(1, 0) : (second_focus - first_focus) / (2 * focus_dist);
+    frame.long_axis = long_axis;
+    frame.short_axis = sqrt(std::max(long_axis * long_axis - focus_dist * focus_dist, 0.0));
+    double outer = long_axis + eps / 2;
+    double inv_long = 1 / (outer * outer);
+    double inv_short = 1 / (outer * outer - focus_dist * focus_dist);
+    double ux = frame.axis.x;
+    double uy = frame.axis.y;
+    frame.xx = ux * ux * inv_long + uy * uy * inv_short;
+    frame.xy = ux * uy * (inv_long - inv_short);
+    frame.yy = uy * uy * inv_long + ux * ux * inv_short;
+}
 
 double Ellipse::area() const {
-    double focus_dist = (first_focus - second_focus).len() / 2;
-    double short_axis = sqrt(long_axis * long_axis - focus_dist * focus_dist);
-    return pi * long_axis * short_axis;
+    if (!area_) {
+        area_ = pi * long_axis * semiAxes().second;
+    }
+    return *area_;
 }
 
 double Ellipse::perimeter() const {
-    double focus_dist = (first_focus - second_focus).len() / 2;
-    double short_axis = sqrt(long_axis * long_axis - focus_dist * focus_dist);
-    return pi * (3 * (long_axis + short_axis) - sqrt((3 * long_axis + short_axis) * (long_axis + 3 * short_axis)));
+    if (!perimeter_) {
+        double short_axis = semiAxes().second;
+        perimeter_ = pi * (3 * (long_axis + short_axis) - sqrt((3 * long_axis + short_axis) * (long_axis + 3 * short_axis)));
+    }
+    return *perimeter_;
 }
 
 std::pair<Point, Point> Ellipse::focuses() const {
@@ -278,32 +1480,102 @@ double Ellipse::eccentricity() const {
 }
 
 Point Ellipse::center() const {
-    return (first_focus + second_focus) / 2;
+    return frame.center;
 }
 
 bool Ellipse::containsPoint(const Point& point) const {
-    return (point - first_focus).len() + (point - second_focus).len() <= 2 * long_axis + eps;
+    double dx = point.x - frame.center.x;
+    double dy = point.y - frame.center.y;
+    return frame.xx * dx * dx + 2 * frame.xy * dx * dy + frame.yy * dy * dy <= 1;
 }
 
-void Ellipse::reflect(const Point& center) {
-    first_focus.reflect(center);
-    second_focus.reflect(center);
+std::vector<bool> Ellipse::containsPoints(std::span<const Point> query) const {
+    static const size_t block = 256;
+    std::vector<bool> result(query.size());
+    bool inside[block];
+    for (size_t first = 0; first < query.size(); first += block) {
+        size_t count = std::min(block, query.size() - first);
+        const Point* chunk = query.data() + first;
+        for (size_t j = 0; j < count; ++j) {
+            double dx = chunk[j].x - frame.center.x;
+            double dy = chunk[j].y - frame.center.y;
+            inside[j] = frame.xx * dx * dx + 2 * frame.xy * dx * dy + frame.yy * dy * dy <= 1;
+        }
+        for (size_t j = 0; j < count; ++j) {
+            result[first + j] = inside[j];
+        }
+    }
+    return result;
+}
+
+std::pair<double, double> Ellipse::semiAxes() const {
+    return {frame.long_axis, frame.short_axis};
+}
+
+BoundingBox Ellipse::boundingBox() const {
+    if (!bounding_box_) {
+        double a = frame.long_axis;
+        double b = frame.short_axis;
+        Point u = frame.axis;
+        Point half(sqrt(a * a * u.x * u.x + b * b * u.y * u.y), sqrt(a * a * u.y * u.y + b * b * u.x * u.x));
+        bounding_box_ = BoundingBox(frame.center - half, frame.center + half);
+    }
+    return *bounding_box_;
+}
+
+BoundingCircle Ellipse::boundingCircle() const {
+    return {frame.center, frame.long_axis};
+}
+
+Point Ellipse::centroid() const {
+    return center();
+}
+
+void Ellipse::reflect(const Point& center) {
+    apply(AffineTransform::reflection(center));
 }
 
 void Ellipse::reflect(const Line& axis) {
-    first_focus.reflect(axis);
-    second_focus.reflect(axis);
+    apply(AffineTransform::reflection(axis));
 }
 
 void Ellipse::rotate(const Point& center, double angle) {
-    first_focus.rotate(center, angle);
-    second_focus.rotate(center, angle);
+    apply(AffineTransform::rotation(center, angle));
 }
 
 void Ellipse::scale(const Point& center, double coefficient) {
-    first_focus.scale(center, coefficient);
-    second_focus.scale(center, coefficient);
-    long_axis *= fabs(coefficient);
+    apply(AffineTransform::scaling(center, coefficient));
+}
+
+void Ellipse::apply(const AffineTransform& transform) {
+    transform_cache(transform);
+    if (transform.isSimilarity()) {
+        first_focus = transform(first_focus);
+        second_focus = transform(second_focus);
+        long_axis *= transform.similarityRatio();
+        update_frame();
+        return;
+    }
+    Point c = frame.center;
+    Point u = frame.axis;
+    Point v(-u.y, u.x);
+    Point major = transform(c + u * frame.long_axis) - transform(c);
+    Point minor = transform(c + v * frame.short_axis) - transform(c);
+    double p = major.x * major.x + minor.x * minor.x;
+    double q = major.x * major.y + minor.x * minor.y;
+    double r = major.y * major.y + minor.y * minor.y;
+    double disc = sqrt((p - r) * (p - r) / 4 + q * q);
+    double new_long = sqrt((p + r) / 2 + disc);
+    double new_short = sqrt(std::max((p + r) / 2 - disc, 0.0));
+    double new_focus_dist = sqrt(std::max(new_long * new_long - new_short * new_short, 0.0));
+    double theta = atan2(2 * q, p - r) / 2;
+    Point dir(cos(theta), sin(theta));
+    c = transform(c);
+    first_focus = c - dir * new_focus_dist;
+    second_focus = c + dir * new_focus_dist;
+    long_axis = new_long;
+    eccentricity_ = new_long < eps ? 0 : new_focus_dist / new_long;
+    update_frame();
 }
 
 bool Ellipse::operator==(const Shape& other) const {
@@ -321,7 +1593,7 @@ bool Ellipse::isCongruentTo(const Shape& another) const {
     if (ptr == nullptr) {
         return false;
     }
-    return Geometry::equal(long_axis, ptr->long_axis, eps) && Geometry::equal(eccentricity_, ptr->eccentricity_, eps);
+    return isCongruentTo(*ptr);
 }
 
 bool Ellipse::isSimilarTo(const Shape& another) const {
@@ -329,7 +1601,15 @@ bool Ellipse::isSimilarTo(const Shape& another) const {
     if (ptr == nullptr) {
         return false;
     }
-    return Geometry::equal(eccentricity_, ptr->eccentricity_, eps);
+    return isSimilarTo(*ptr);
+}
+
+bool Ellipse::isCongruentTo(const Ellipse& another) const {
+    return Geometry::equal(long_axis, another.long_axis, eps) && Geometry::equal(eccentricity_, another.eccentricity_, eps);
+}
+
+bool Ellipse::isSimilarTo(const Ellipse& another) const {
+    return Geometry::equal(eccentricity_, another.eccentricity_, eps);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -340,33 +1620,71 @@ public:
         first_focus = second_focus = center;
         long_axis = r;
         eccentricity_ = 0;
+        update_frame();
     }
     double radius() { return long_axis; }
+    // false once a non-similarity apply has stretched the circle into an ellipse
+    bool isRound() const { return frame.xy == 0 && frame.xx == frame.yy; }
+    bool containsPoint(const Point& point) const override {
+        if (!isRound()) return Ellipse::containsPoint(point);
+        double dx = point.x - frame.center.x;
+        double dy = point.y - frame.center.y;
+        return (dx * dx + dy * dy) * frame.xx <= 1;
+    }
     bool operator==(const Circle& other) const {
         return first_focus == other.first_focus && Geometry::equal(long_axis, other.long_axis, eps);
     }
 };
 
+class Triangle;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 class Polygon : public Shape {
 public:
     Polygon() = default;
 
+    explicit Polygon(std::pmr::memory_resource* resource): points(resource), is_convex(true) {}
+
     template <typename... Args>
-    explicit Polygon(Args... args) : points({args...}), is_convex(check_convex(points)) {}
+    requires (std::is_convertible_v<Args, Point> && ...)
+    explicit Polygon(Args... args) : points({args...}), is_convex(Geometry::polygon_convex(points)) {}
+
+    Polygon(const std::vector<Point>& v): points(v.begin(), v.end()), is_convex(Geometry::polygon_convex(points)) {}
+
+    Polygon(std::span<const Point> v, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : points(v.begin(), v.end(), resource), is_convex(Geometry::polygon_convex(points)) {}
+
+    Polygon(const std::initializer_list<Point>& vert):  points(vert), is_convex(Geometry::polygon_convex(points)) {}
+
+    Polygon(const std::initializer_list<Point>& vert, std::pmr::memory_resource* resource)
+            : points(vert, resource), is_convex(Geometry::polygon_convex(points)) {}
+
+    Polygon(const Polygon& other) = default;
+
+    Polygon(Polygon&& other) = default;
+
+    Polygon(const Polygon& other, std::pmr::memory_resource* resource);
 
-    Polygon(const std::vector<Point>& v): points(v), is_convex(check_convex(points)) {}
+    Polygon& operator=(const Polygon& other) = default;
 
-    Polygon(const std::initializer_list<Point>& vert):  points(vert), is_convex(check_convex(points)) {}
+    Polygon& operator=(Polygon&& other) = default;
 
     size_t verticesCount() const;
 
-    const std::vector<Point>& getVertices() const;
+    const std::pmr::vector<Point>& getVertices() const;
 
     bool isConvex() const;
 
     bool containsPoint(const Point& point) const override;
 
+    std::vector<bool> containsPoints(std::span<const Point> query) const;
+
+    BoundingBox boundingBox() const override;
+
+    BoundingCircle boundingCircle() const override;
+
+    Point centroid() const override;
+
     void reflect(const Point& center) override;
 
     void reflect(const Line& axis) override;
@@ -375,6 +1693,10 @@ public:
 
     void scale(const Point& center, double coefficient) override;
 
+    void apply(const AffineTransform& transform) override;
+
+    void precompute() const override;
+
     bool operator==(const Shape& other) const override;
 
     virtual bool isCongruentTo(const Shape& another) const override;
@@ -383,6 +1705,47 @@ public:
 
     bool operator==(const Polygon& other) const;
 
+    bool isCongruentTo(const Polygon& another) const;
+
+    bool isSimilarTo(const Polygon& another) const;
+
+    size_t similarityHash() const;
+
+    Polygon intersection(const Polygon& other) const;
+
+    double intersectionArea(const Polygon& other) const;
+
+    Polygon clip(const Polygon& window) const;
+
+    enum class Simplification { DouglasPeucker, VisvalingamWhyatt };
+
+    // tolerance is a distance for Douglas-Peucker and a triangle area for Visvalingam-Whyatt;
+    // at least three vertices are kept. With preserve_topology no two edges of the result
+    // cross, with preserve_convexity every kept vertex turns the way it does here.
+    Polygon simplify(Simplification method, double tolerance, bool preserve_topology = false,
+                     bool preserve_convexity = false) const;
+
+    // the vertex is inserted before index, index == verticesCount() appends. After an O(n)
+    // first edit, area, perimeter and convexity follow every edit in O(1). Shapes whose type
+    // fixes their vertices throw std::logic_error for the edits that would break it.
+    void insertVertex(size_t index, const Point& point);
+
+    void removeVertex(size_t index);
+
+    void moveVertex(size_t index, const Point& point);
+
+    // triangles over vertex indices, each with the orientation of the polygon; cached until the
+    // polygon degenerates. Throws std::invalid_argument if the polygon is not simple.
+    const std::vector<std::array<size_t, 3>>& triangulation() const;
+
+    std::vector<Triangle> triangles() const;
+
+    // uniformly distributed over the area of a simple polygon
+    template <typename Generator>
+    Point randomPoint(Generator& generator) const;
+
+    friend Polygon convexHull(std::span<const Point> cloud);
+
     ~Polygon() override = default;
 
     double perimeter() const override;
@@ -390,95 +1753,328 @@ public:
     double area() const override;
 
 protected:
-    std::vector <Point> points;
+    std::pmr::vector<Point> points;
     bool is_convex;
 
-    static bool check_convex(std::vector<Point>& v);
+    // the vertex edits check this, so that a Triangle or Rectangle edited through a Polygon&
+    // stays what its type says
+    enum class Edit { Insert, Remove, Move };
+
+    virtual bool allows(Edit) const { return true; }
+    // orientation of the triangle fan around points[0], 0 if the fan does not cover the polygon
+    mutable std::optional<int> fan_orientation;
+
+    // edge i divided by the perimeter and the turn after it, signed so that the polygon turns left
+    struct SignatureToken {
+        double edge;
+        double turn;
+    };
+
+    mutable std::optional<std::vector<SignatureToken>> signature_;
+    mutable std::optional<size_t> similarity_hash_;
+
+    const std::vector<SignatureToken>& signature() const;
+
+    std::vector<SignatureToken> reversed_signature() const;
+
+    std::vector<std::pair<Point, Point>> counterclockwise_edges() const;
+
+    static std::vector<Point> intersect_halfplanes(const std::vector<std::pair<Point, Point>>& first,
+                                                   const std::vector<std::pair<Point, Point>>& second);
+
+    int fan() const;
+
+    bool fan_contains(const Point& point, int orientation) const;
 
-    bool check_similar_angles(const std::vector<Point>& other_polygon, size_t first_begin, size_t second_begin, int step) const;
+    // false only for points the edge test cannot accept either, see the definition
+    bool near(const Point& point) const;
+
+    // the tree is a median split over triangle boxes with the left child right after its parent;
+    // transforms only clear it, the triangles and their relative areas survive any regular map
+    struct Triangulation {
+        bool simple;
+        std::vector<std::array<size_t, 3>> triangles;
+        std::vector<double> cumulative_area;
+
+        struct Node {
+            BoundingBox box;
+            size_t right;
+            size_t first;
+            size_t count;
+        };
+
+        std::vector<Node> tree;
+        std::vector<size_t> items;
+    };
+
+    static const size_t triangulation_threshold = 64;
+
+    // turns at vertices tallied as polygon_convex does: left if counterclockwise, right otherwise
+    struct TurnCount {
+        ptrdiff_t left;
+        ptrdiff_t right;
+    };
+
+    // signed shoelace sum and turn counts, kept current by the vertex edits once known
+    mutable std::optional<double> doubled_area_;
+    mutable std::optional<TurnCount> turns_;
+
+    void begin_edit();
+
+    void end_edit();
+
+    void count_turn(size_t index, ptrdiff_t delta);
+
+    void count_edge(size_t from, size_t to, double delta);
+
+    mutable std::optional<Triangulation> triangulation_;
+
+    const Triangulation& triangulation_cache() const;
+
+    size_t build_triangle_tree(size_t first, size_t last) const;
+
+    void triangle_tree() const;
+
+    bool triangulation_contains(const Point& point) const;
 };
 
 size_t Polygon::verticesCount() const { return points.size(); }
 
-bool Polygon::check_convex(std::vector<Point> &v) {
-    int cnt_left = 0, cnt_right = 0;
-    v.push_back(v[0]);
-    v.push_back(v[1]);
-    for (size_t i = 1; i < v.size() - 1; ++i) {
-        if ((v[i] - v[i - 1]).crossProduct(v[i + 1] - v[i]) > 0) {
-            ++cnt_left;
-        } else {
-            ++cnt_right;
-        }
-    }
-    v.pop_back();
-    v.pop_back();
-    return cnt_right == 0 || cnt_left == 0;
-}
+Polygon::Polygon(const Polygon& other, std::pmr::memory_resource* resource): Shape(other)
+        , points(other.points, resource), is_convex(other.is_convex), fan_orientation(other.fan_orientation)
+        , signature_(other.signature_), similarity_hash_(other.similarity_hash_), doubled_area_(other.doubled_area_)
+        , turns_(other.turns_), triangulation_(other.triangulation_) {}
 
-const std::vector<Point>& Polygon::getVertices() const { return points; }
+const std::pmr::vector<Point>& Polygon::getVertices() const { return points; }
 
 bool Polygon::isConvex() const { return is_convex; }
 
 double Polygon::perimeter() const {
-    double result = 0;
-    for (size_t i = 1; i < points.size(); ++i) {
-        result += (points[i] - points[i - 1]).len();
+    if (!perimeter_) {
+        perimeter_ = Geometry::polygon_perimeter(points);
     }
-    result += (points.back() - points[0]).len();
-    return result;
+    return *perimeter_;
 }
 
 double Polygon::area() const {
-    double result = 0;
-    for (size_t i = 2; i < points.size(); ++i) {
-        result += (points[i] - points[0]).crossProduct(points[i - 1] - points[0]);
+    if (!area_) {
+        area_ = doubled_area_ ? fabs(*doubled_area_) / 2 : Geometry::polygon_area(points);
     }
-    return fabs(result) / 2;
+    return *area_;
+}
+
+Point Polygon::centroid() const {
+    if (!centroid_) {
+        double doubled_area = 0;
+        Point weighted;
+        Point mean;
+        for (size_t i = 0; i < points.size(); ++i) {
+            const Point& cur = points[i];
+            const Point& next = points[i + 1 == points.size() ? 0 : i + 1];
+            double cross = cur.crossProduct(next);
+            doubled_area += cross;
+            weighted += (cur + next) * cross;
+            mean += cur;
+        }
+        centroid_ = fabs(doubled_area) < eps ? mean / points.size() : weighted / (3 * doubled_area);
+    }
+    return *centroid_;
+}
+
+int Polygon::fan() const {
+    if (fan_orientation) return *fan_orientation;
+    fan_orientation = 0;
+    size_t n = points.size();
+    if (n < 3) return 0;
+    double doubled_area = 0;
+    for (size_t i = 1; i + 1 < n; ++i) {
+        doubled_area += (points[i] - points[0]).crossProduct(points[i + 1] - points[0]);
+    }
+    int orientation = doubled_area > 0 ? 1 : -1;
+    for (size_t i = 1; i + 1 < n; ++i) {
+        if (orientation * Geometry::orientation(points[0], points[i], points[i + 1]) < 0) return 0;
+    }
+    if (orientation * Geometry::orientation(points[0], points[1], points[n - 1]) <= 0) return 0;
+    return *fan_orientation = orientation;
+}
+
+// A point outside the fan is still inside when it is within eps of an edge. Only the edges
+// facing it and the first edge past that chain on either side can be that close.
+bool Polygon::fan_contains(const Point& point, int orientation) const {
+    size_t n = points.size();
+    const Point& origin = points[0];
+    auto next = [n](size_t i) { return i + 1 == n ? 0 : i + 1; };
+    auto near_edges = [&](size_t edge) {
+        for (bool forward : {true, false}) {
+            for (size_t i = edge, steps = 0; steps < n; i = forward ? next(i) : (i == 0 ? n - 1 : i - 1), ++steps) {
+                const Point& a = points[i];
+                const Point& b = points[next(i)];
+                if (fabs((a - point).crossProduct(b - point)) < eps && (a - point).dotProduct(b - point) <= 0) return true;
+                if (orientation * Geometry::orientation(point, a, b) > 0) break;
+            }
+        }
+        return false;
+    };
+    if (orientation * Geometry::orientation(origin, points[1], point) < 0) return near_edges(0);
+    if (orientation * Geometry::orientation(origin, points[n - 1], point) > 0) return near_edges(n - 1);
+    size_t lo = 1;
+    size_t hi = n - 1;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (orientation * Geometry::orientation(origin, points[mid], point) >= 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return orientation * Geometry::orientation(point, points[lo], points[lo + 1]) > 0 || near_edges(lo);
+}
+
+// The edge test accepts |cross| < eps between the ends of an edge of length l, which reaches
+// min(eps / l, l / 2) <= sqrt(eps / 2) away from it, so both bounds are widened by that much.
+bool Polygon::near(const Point& point) const {
+    const double margin = sqrt(eps / 2);
+    BoundingBox box = Polygon::boundingBox();
+    if (point.x < box.lower.x - margin || point.x > box.upper.x + margin
+        || point.y < box.lower.y - margin || point.y > box.upper.y + margin) {
+        return false;
+    }
+    BoundingCircle circle = Polygon::boundingCircle();
+    return BoundingCircle(circle.center, circle.radius + margin).containsPoint(point);
 }
 
+// a non-convex polygon answers from its triangulation once one has been built
 bool Polygon::containsPoint(const Point& point) const {
-    double angle = 0;
-    for (size_t i = 0; i + 1 < points.size(); ++i) {
-        if (fabs((points[i] - point).crossProduct(points[i + 1] - point)) < eps
-            && (points[i] - point).dotProduct(points[i + 1] - point) <= 0) return true;
+    if (!near(point)) return false;
+    if (is_convex) {
+        if (int orientation = fan()) return fan_contains(point, orientation);
     }
-    if (fabs((points.back() - point).crossProduct(points[0] - point)) < eps
-        && (points.back() - point).dotProduct(points[0] - point) <= 0) return true;
+    if (triangulation_ && triangulation_->simple) return triangulation_contains(point);
+    return Geometry::polygon_contains(points, point);
+}
 
-    for (size_t i = 0; i + 1 < points.size(); ++i) {
-        angle += atan2((points[i] - point).crossProduct(points[i + 1] - point),
-                       (points[i] - point).dotProduct(points[i + 1] - point));
+std::vector<bool> Polygon::containsPoints(std::span<const Point> query) const {
+    static const size_t block = 256;
+    std::vector<bool> result(query.size());
+    if (is_convex) {
+        if (int orientation = fan()) {
+            for (size_t j = 0; j < query.size(); ++j) {
+                result[j] = near(query[j]) && fan_contains(query[j], orientation);
+            }
+            return result;
+        }
+    }
+    if (points.size() >= triangulation_threshold && query.size() >= triangulation_threshold && triangulation_cache().simple) {
+        for (size_t j = 0; j < query.size(); ++j) {
+            result[j] = near(query[j]) && triangulation_contains(query[j]);
+        }
+        return result;
+    }
+    // queries whose cross product sign is within the rounding bound are redone exactly
+    double xs[block];
+    double ys[block];
+    int winding[block];
+    int border[block];
+    int uncertain[block];
+    for (size_t first = 0; first < query.size(); first += block) {
+        size_t count = std::min(block, query.size() - first);
+        for (size_t j = 0; j < count; ++j) {
+            xs[j] = query[first + j].x;
+            ys[j] = query[first + j].y;
+            winding[j] = 0;
+            border[j] = 0;
+            uncertain[j] = 0;
+        }
+        for (size_t i = 0; i < points.size(); ++i) {
+            const Point cur = points[i];
+            const Point next = points[i + 1 == points.size() ? 0 : i + 1];
+            for (size_t j = 0; j < count; ++j) {
+                double ax = cur.x - xs[j];
+                double ay = cur.y - ys[j];
+                double bx = next.x - xs[j];
+                double by = next.y - ys[j];
+                double cross = ax * by - ay * bx;
+                double dot = ax * bx + ay * by;
+                border[j] |= (fabs(cross) < eps) & (dot <= 0);
+                uncertain[j] |= fabs(cross) <= Geometry::orient_bound * (fabs(ax * by) + fabs(ay * bx));
+                winding[j] += ((ay <= 0) & (by > 0) & (cross > 0)) - ((ay > 0) & (by <= 0) & (cross < 0));
+            }
+        }
+        for (size_t j = 0; j < count; ++j) {
+            result[first + j] = border[j] || (uncertain[j] ? Geometry::polygon_contains(points, query[first + j]) : winding[j] != 0);
+        }
     }
-    angle += atan2((points.back() - point).crossProduct(points[0] - point),
-                   (points.back() - point).dotProduct(points[0] - point));
-    if (fabs(angle) < 1) return false;
-    return true;
+    return result;
 }
 
-void Polygon::reflect(const Point& center) {
-    for (Point& p : points) {
-        p.reflect(center);
+BoundingBox Polygon::boundingBox() const {
+    if (!bounding_box_) {
+        BoundingBox box;
+        for (const Point& p : points) {
+            box.extend(p);
+        }
+        bounding_box_ = box;
     }
+    return *bounding_box_;
 }
 
-void Polygon::reflect(const Line& axis) {
-    for (Point& p : points) {
-        p.reflect(axis);
+BoundingCircle Polygon::boundingCircle() const {
+    if (!bounding_circle_) {
+        bounding_circle_ = Geometry::enclosing_circle(points);
     }
+    return *bounding_circle_;
+}
+
+void Polygon::reflect(const Point& center) {
+    apply(AffineTransform::reflection(center));
+}
+
+void Polygon::reflect(const Line& axis) {
+    apply(AffineTransform::reflection(axis));
 }
 
 void Polygon::rotate(const Point& center, double angle) {
-    for (Point& p : points) {
-        p.rotate(center, angle);
-    }
+    apply(AffineTransform::rotation(center, angle));
 }
 
 void Polygon::scale(const Point& center, double coefficient) {
-   for (Point& p : points) {
-       p.scale(center, coefficient);
-   }
-   is_convex = check_convex(points);
+    apply(AffineTransform::scaling(center, coefficient));
+}
+
+void Polygon::precompute() const {
+    Shape::precompute();
+    fan();
+    signature();
+    similarityHash();
+    triangulation_cache();
+    triangle_tree();
+}
+
+void Polygon::apply(const AffineTransform& transform) {
+    transform_cache(transform);
+    for (Point& p : points) {
+        p = transform(p);
+    }
+    if (fabs(transform.determinant()) < AffineTransform::eps || !transform.isSimilarity()) {
+        signature_.reset();
+        similarity_hash_.reset();
+    }
+    if (doubled_area_) {
+        *doubled_area_ *= transform.determinant();
+    }
+    turns_.reset();
+    if (fabs(transform.determinant()) < AffineTransform::eps) {
+        is_convex = Geometry::polygon_convex(points);
+        fan_orientation.reset();
+        triangulation_.reset();
+        return;
+    }
+    if (fan_orientation && transform.determinant() < 0) {
+        fan_orientation = -*fan_orientation;
+    }
+    if (triangulation_) {
+        triangulation_->tree.clear();
+    }
 }
 
 bool Polygon::operator==(const Shape& other) const {
@@ -491,63 +2087,281 @@ bool Polygon::isCongruentTo(const Shape& another) const {
     return fabs(perimeter() - another.perimeter()) < eps && isSimilarTo(another);
 }
 
+bool Polygon::isCongruentTo(const Polygon& another) const {
+    return fabs(Polygon::perimeter() - another.Polygon::perimeter()) < eps && isSimilarTo(another);
+}
+
+const std::vector<Polygon::SignatureToken>& Polygon::signature() const {
+    if (!signature_) {
+        size_t n = points.size();
+        double doubled_area = 0;
+        for (size_t i = 0; i < n; ++i) {
+            doubled_area += points[i].crossProduct(points[(i + 1) % n]);
+        }
+        double orientation = doubled_area < 0 ? -1 : 1;
+        double total = perimeter();
+        std::vector<SignatureToken> result(n);
+        for (size_t i = 0; i < n; ++i) {
+            Point edge = points[(i + 1) % n] - points[i];
+            Point next = points[(i + 2) % n] - points[(i + 1) % n];
+            result[i].edge = total < eps ? 0 : edge.len() / total;
+            result[i].turn = orientation * atan2(edge.crossProduct(next), edge.dotProduct(next));
+        }
+        signature_ = std::move(result);
+    }
+    return *signature_;
+}
+
+// the same polygon walked backwards: edge i - 1 is followed by the turn before it
+std::vector<Polygon::SignatureToken> Polygon::reversed_signature() const {
+    const std::vector<SignatureToken>& forward = signature();
+    size_t n = forward.size();
+    std::vector<SignatureToken> result(n);
+    for (size_t k = 0; k < n; ++k) {
+        size_t edge = n - 1 - k;
+        result[k] = {forward[edge].edge, forward[(edge + n - 1) % n].turn};
+    }
+    return result;
+}
+
 bool Polygon::isSimilarTo(const Shape& another) const {
     const Polygon* ptr = dynamic_cast<const Polygon*>(&another);
     if (ptr == nullptr) return false;
-    if (verticesCount() != ptr->verticesCount() || is_convex != ptr->is_convex) return false;
-    size_t len = verticesCount();
-    for (size_t i = 0; i < verticesCount(); ++i) {
-        bool similar_left = true;
-        bool similar_right = true;
-        for (size_t j = 0; j < verticesCount(); ++j) {
-            similar_left &= check_similar_angles(ptr->points, j, (j + i) % len, 1);
-            similar_right &= check_similar_angles(ptr->points, j, (i + len - j) % len, -1);
-        }
-        if (similar_left || similar_right) return true;
-    }
-    return false;
+    return isSimilarTo(*ptr);
 }
 
-bool Polygon::check_similar_angles(const std::vector<Point>& other_polygon, size_t first_begin, size_t second_begin, int step) const {
-    size_t len = points.size();
-    Point a = points[first_begin];
-    Point b = points[(first_begin + 1) % len];
-    Point c = points[(first_begin + 2) % len];
-    Point x = other_polygon[second_begin];
-    Point y = other_polygon[(second_begin + step + len) % len];
-    Point z = other_polygon[(second_begin + step * 2 + len) % len];
-    if (fabs((b - a).len() / (y - x).len() - (c - b).len() / (z - y).len()) > eps) return false;
-    if (fabs(atan2((b - a).crossProduct(c - b), (b - a).dotProduct(c - b))
-             - atan2((b - a).crossProduct(c - b), (b - a).dotProduct(c - b))) > eps) return false;
-    return true;
+// the signature tolerates eps per token, so accepted polygons may differ by n * eps of the
+// perimeter; bounding radii further apart than that cannot be similar
+bool Polygon::isSimilarTo(const Polygon& another) const {
+    if (verticesCount() != another.verticesCount() || is_convex != another.is_convex) return false;
+    double p = Polygon::perimeter();
+    double q = another.Polygon::perimeter();
+    if (fabs(Polygon::boundingCircle().radius * q - another.Polygon::boundingCircle().radius * p) > 2 * verticesCount() * eps * p * q) return false;
+    auto eq = [](const SignatureToken& first, const SignatureToken& second) {
+        return Geometry::equal(first.edge, second.edge, eps) && Geometry::equal(first.turn, second.turn, eps);
+    };
+    return Geometry::cyclic_shift(signature(), another.signature(), eq)
+        || Geometry::cyclic_shift(signature(), another.reversed_signature(), eq);
 }
 
 bool Polygon::operator==(const Polygon& other) const {
     if (verticesCount() != other.verticesCount()) return false;
-    for (size_t i = 0; i < verticesCount(); ++i) {
-        bool equal_left = true;
-        bool equal_right = true;
-        for (size_t j = 0; j < verticesCount(); ++j) {
-            equal_left = points[j] == other.points[(i + j) % verticesCount()];
-            equal_right = points[j] == other.points[(i + verticesCount() - j) % verticesCount()];
+    auto eq = [](const Point& first, const Point& second) { return first == second; };
+    std::vector<Point> reversed(other.points.rbegin(), other.points.rend());
+    return Geometry::cyclic_shift(points, other.points, eq) || Geometry::cyclic_shift(points, reversed, eq);
+}
+
+// equal for similar polygons unless a token lies on a quantization boundary
+size_t Polygon::similarityHash() const {
+    if (!similarity_hash_) {
+        static const constexpr double quantum = 1e-6;
+        auto quantize = [](const std::vector<SignatureToken>& tokens) {
+            std::vector<std::pair<long long, long long>> result(tokens.size());
+            for (size_t i = 0; i < tokens.size(); ++i) {
+                result[i] = {std::llround(tokens[i].edge / quantum), std::llround(tokens[i].turn / quantum)};
+            }
+            return result;
+        };
+        std::vector<std::pair<long long, long long>> forward = quantize(signature());
+        std::vector<std::pair<long long, long long>> backward = quantize(reversed_signature());
+        size_t n = forward.size();
+        size_t forward_start = Geometry::least_rotation(forward);
+        size_t backward_start = Geometry::least_rotation(backward);
+        bool use_backward = false;
+        for (size_t k = 0; k < n; ++k) {
+            const auto& f = forward[(forward_start + k) % n];
+            const auto& b = backward[(backward_start + k) % n];
+            if (f != b) {
+                use_backward = b < f;
+                break;
+            }
+        }
+        const std::vector<std::pair<long long, long long>>& canonical = use_backward ? backward : forward;
+        size_t start = use_backward ? backward_start : forward_start;
+        size_t hash = n;
+        for (size_t k = 0; k < n; ++k) {
+            const auto& token = canonical[(start + k) % n];
+            hash ^= std::hash<long long>()(token.first) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            hash ^= std::hash<long long>()(token.second) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
         }
-        if (equal_left || equal_right) return true;
+        similarity_hash_ = hash;
     }
-    return false;
+    return *similarity_hash_;
+}
+
+// (start, direction) of every non-degenerate edge, counterclockwise, starting from the
+// edge with the least polar angle of direction; the polygon must be convex
+std::vector<std::pair<Point, Point>> Polygon::counterclockwise_edges() const {
+    size_t n = points.size();
+    double doubled_area = 0;
+    for (size_t i = 0; i < n; ++i) {
+        doubled_area += points[i].crossProduct(points[(i + 1) % n]);
+    }
+    std::vector<std::pair<Point, Point>> edges;
+    edges.reserve(n);
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = doubled_area >= 0 ? k : n - 1 - k;
+        size_t j = doubled_area >= 0 ? (i + 1) % n : (i + n - 1) % n;
+        Point dir = points[j] - points[i];
+        if (dir.len() > eps) edges.push_back({points[i], dir});
+    }
+    auto upper = [](const Point& v) { return v.y > 0 || (v.y == 0 && v.x > 0); };
+    auto before = [&](const Point& lhs, const Point& rhs) {
+        if (upper(lhs) != upper(rhs)) return upper(lhs);
+        return Geometry::orientation(Point(0, 0), lhs, rhs) > 0;
+    };
+    auto first = std::min_element(edges.begin(), edges.end(), [&](const auto& lhs, const auto& rhs) {
+        return before(lhs.second, rhs.second);
+    });
+    std::rotate(edges.begin(), first, edges.end());
+    return edges;
+}
+
+// both lists are sorted by polar angle, so merging them gives the sorted order the
+// deque-based half-plane intersection needs without a sort
+std::vector<Point> Polygon::intersect_halfplanes(const std::vector<std::pair<Point, Point>>& first,
+                                                 const std::vector<std::pair<Point, Point>>& second) {
+    auto upper = [](const Point& v) { return v.y > 0 || (v.y == 0 && v.x > 0); };
+    auto before = [&](const std::pair<Point, Point>& lhs, const std::pair<Point, Point>& rhs) {
+        if (upper(lhs.second) != upper(rhs.second)) return upper(lhs.second);
+        return Geometry::orientation(Point(0, 0), lhs.second, rhs.second) > 0;
+    };
+    std::vector<std::pair<Point, Point>> planes(first.size() + second.size());
+    std::merge(first.begin(), first.end(), second.begin(), second.end(), planes.begin(), before);
+    auto outside = [](const std::pair<Point, Point>& plane, const Point& p) {
+        return plane.second.crossProduct(p - plane.first) < -eps;
+    };
+    auto meet = [](const std::pair<Point, Point>& lhs, const std::pair<Point, Point>& rhs) {
+        return Line(lhs.first, lhs.first + lhs.second) * Line(rhs.first, rhs.first + rhs.second);
+    };
+    std::vector<std::pair<Point, Point>> deque(planes.size());
+    size_t head = 0;
+    size_t tail = 0;
+    for (const auto& plane : planes) {
+        while (tail - head > 1 && outside(plane, meet(deque[tail - 1], deque[tail - 2]))) --tail;
+        while (tail - head > 1 && outside(plane, meet(deque[head], deque[head + 1]))) ++head;
+        if (tail - head > 0 && fabs(plane.second.crossProduct(deque[tail - 1].second)) < eps) {
+            if (plane.second.dotProduct(deque[tail - 1].second) < 0) return {};
+            if (!outside(plane, deque[tail - 1].first)) continue;
+            --tail;
+        }
+        deque[tail++] = plane;
+    }
+    while (tail - head > 2 && outside(deque[head], meet(deque[tail - 1], deque[tail - 2]))) --tail;
+    while (tail - head > 2 && outside(deque[tail - 1], meet(deque[head], deque[head + 1]))) ++head;
+    if (tail - head < 3) return {};
+    std::vector<Point> result;
+    result.reserve(tail - head);
+    for (size_t i = head; i < tail; ++i) {
+        Point p = meet(deque[i], deque[i + 1 == tail ? head : i + 1]);
+        if (result.empty() || !(result.back() == p)) result.push_back(p);
+    }
+    while (result.size() > 1 && result.back() == result[0]) result.pop_back();
+    return result;
+}
+
+Polygon Polygon::intersection(const Polygon& other) const {
+    if (!other.is_convex) {
+        if (!is_convex) throw std::invalid_argument("Polygon::intersection: neither polygon is convex");
+        return other.clip(*this);
+    }
+    if (!is_convex) return clip(other);
+    Polygon result(points.get_allocator().resource());
+    if (boundingBox().intersects(other.boundingBox())) {
+        std::vector<Point> vertices = intersect_halfplanes(counterclockwise_edges(), other.counterclockwise_edges());
+        result.points.assign(vertices.begin(), vertices.end());
+    }
+    return result;
+}
+
+double Polygon::intersectionArea(const Polygon& other) const {
+    if (!is_convex || !other.is_convex) return intersection(other).area();
+    if (!boundingBox().intersects(other.boundingBox())) return 0;
+    std::vector<Point> vertices = intersect_halfplanes(counterclockwise_edges(), other.counterclockwise_edges());
+    double result = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        result += vertices[i].crossProduct(vertices[i + 1 == vertices.size() ? 0 : i + 1]);
+    }
+    return fabs(result) / 2;
+}
+
+// Sutherland-Hodgman; a non-convex subject may come out with zero-width bridges
+Polygon Polygon::clip(const Polygon& window) const {
+    if (!window.is_convex) throw std::invalid_argument("Polygon::clip: window is not convex");
+    std::vector<Point> current(points.begin(), points.end());
+    std::vector<Point> next;
+    for (const auto& [start, dir] : window.counterclockwise_edges()) {
+        if (current.empty()) break;
+        next.clear();
+        for (size_t i = 0; i < current.size(); ++i) {
+            const Point& cur = current[i];
+            const Point& prev = current[i == 0 ? current.size() - 1 : i - 1];
+            bool cur_in = dir.crossProduct(cur - start) >= -eps;
+            bool prev_in = dir.crossProduct(prev - start) >= -eps;
+            if (cur_in != prev_in) {
+                next.push_back(Line(prev, cur) * Line(start, start + dir));
+            }
+            if (cur_in) next.push_back(cur);
+        }
+        std::swap(current, next);
+    }
+    Polygon result(points.get_allocator().resource());
+    result.points.assign(current.begin(), current.end());
+    result.is_convex = result.points.size() < 3 || Geometry::polygon_convex(result.points);
+    return result;
+}
+
+Polygon Polygon::simplify(Simplification method, double tolerance, bool preserve_topology, bool preserve_convexity) const {
+    if (!(tolerance >= 0)) throw std::invalid_argument("Polygon::simplify: negative tolerance");
+    std::vector<char> keep = method == Simplification::DouglasPeucker ? Geometry::douglas_peucker(points, tolerance)
+                                                                     : Geometry::visvalingam_whyatt(points, tolerance);
+    if (preserve_topology || preserve_convexity) {
+        Geometry::repair_simplification(points, keep, preserve_topology, preserve_convexity);
+    }
+    Polygon result(points.get_allocator().resource());
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) result.points.push_back(points[i]);
+    }
+    result.is_convex = Geometry::polygon_convex(result.points);
+    return result;
+}
+
+// every polygon is simplified on its own; the results follow the input order
+std::vector<Polygon> simplify(std::span<const Polygon> polygons, Polygon::Simplification method, double tolerance,
+                              bool preserve_topology = false, bool preserve_convexity = false) {
+    if (!(tolerance >= 0)) throw std::invalid_argument("simplify: negative tolerance");
+    std::vector<Polygon> result(polygons.size());
+    Geometry::parallel_for(polygons.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            result[i] = polygons[i].simplify(method, tolerance, preserve_topology, preserve_convexity);
+        }
+    }, 16);
+    return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////
 
 class Rectangle : public Polygon {
 public:
-    Rectangle(const Point& first, const Point& second, double c);
+    Rectangle(const Point& first, const Point& second, double c,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     Point center();
 
     std::pair<Line, Line> diagonals();
+
+    void insertVertex(size_t index, const Point& point) = delete;
+
+    void removeVertex(size_t index) = delete;
+
+    void moveVertex(size_t index, const Point& point) = delete;
+
+protected:
+    bool allows(Edit) const override { return false; }
 };
 
-Rectangle::Rectangle(const Point& first, const Point& second, double c) {
+Rectangle::Rectangle(const Point& first, const Point& second, double c, std::pmr::memory_resource* resource)
+        : Polygon(resource) {
     if (c > 1) c = 1 / c;
     double angle = atan(c) / pi * 180;
     double b = sqrt(pow((first - second).len(), 2) / (c * c + 1));
@@ -574,13 +2388,283 @@ std::pair<Line, Line> Rectangle::diagonals() {
 //////////////////////////////////////////////////////////////////////////////////////
 class Square : public Rectangle {
 public:
-    Square(const Point& a, const Point& b): Rectangle(a, b, 1) {}
+    Square(const Point& a, const Point& b, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : Rectangle(a, b, 1, resource) {}
 
     Circle circumscribedCircle() { return {center(), (points[0] - points[2]).len() / 2}; }
 
     Circle inscribedCircle() { return {center(), (points[0] - points[1]).len() / 2}; }
 };
+void Polygon::count_turn(size_t index, ptrdiff_t delta) {
+    size_t n = points.size();
+    const Point& prev = points[index == 0 ? n - 1 : index - 1];
+    const Point& next = points[index + 1 == n ? 0 : index + 1];
+    if (Geometry::orientation(prev, points[index], next) > 0) {
+        turns_->left += delta;
+    } else {
+        turns_->right += delta;
+    }
+}
+
+void Polygon::count_edge(size_t from, size_t to, double delta) {
+    *doubled_area_ += delta * points[from].crossProduct(points[to]);
+    *perimeter_ += delta * (points[to] - points[from]).len();
+}
+
+// fills the edit-maintained quantities and drops the caches no edit keeps
+void Polygon::begin_edit() {
+    size_t n = points.size();
+    if (!turns_) {
+        turns_ = TurnCount{0, 0};
+        for (size_t i = 0; i < n; ++i) {
+            count_turn(i, 1);
+        }
+    }
+    if (!doubled_area_) {
+        doubled_area_ = 0;
+        for (size_t i = 0; i < n; ++i) {
+            *doubled_area_ += points[i].crossProduct(points[i + 1 == n ? 0 : i + 1]);
+        }
+    }
+    Polygon::perimeter();
+    centroid_.reset();
+    fan_orientation.reset();
+    signature_.reset();
+    similarity_hash_.reset();
+    triangulation_.reset();
+}
+
+void Polygon::end_edit() {
+    area_ = fabs(*doubled_area_) / 2;
+    is_convex = turns_->left == 0 || turns_->right == 0;
+}
+
+void Polygon::insertVertex(size_t index, const Point& point) {
+    size_t n = points.size();
+    if (!allows(Edit::Insert)) throw std::logic_error("Polygon::insertVertex: the shape's type fixes its vertices");
+    if (index > n) throw std::out_of_range("Polygon::insertVertex: index out of range");
+    if (n < 3) {
+        points.insert(points.begin() + index, point);
+        *this = Polygon(std::span<const Point>(points), points.get_allocator().resource());
+        return;
+    }
+    begin_edit();
+    size_t prev = index == 0 ? n - 1 : index - 1;
+    size_t next = index == n ? 0 : index;
+    count_turn(prev, -1);
+    count_turn(next, -1);
+    count_edge(prev, next, -1);
+    points.insert(points.begin() + index, point);
+    prev = index == 0 ? n : index - 1;
+    next = index == n ? 0 : index + 1;
+    count_edge(prev, index, 1);
+    count_edge(index, next, 1);
+    count_turn(prev, 1);
+    count_turn(index, 1);
+    count_turn(next, 1);
+    if (bounding_box_) {
+        bounding_box_->extend(point);
+    }
+    if (bounding_circle_ && !bounding_circle_->containsPoint(point)) {
+        bounding_circle_.reset();
+    }
+    end_edit();
+}
+
+void Polygon::removeVertex(size_t index) {
+    size_t n = points.size();
+    if (!allows(Edit::Remove)) throw std::logic_error("Polygon::removeVertex: the shape's type fixes its vertices");
+    if (index >= n) throw std::out_of_range("Polygon::removeVertex: index out of range");
+    if (n <= 3) {
+        points.erase(points.begin() + index);
+        *this = Polygon(std::span<const Point>(points), points.get_allocator().resource());
+        return;
+    }
+    begin_edit();
+    size_t prev = index == 0 ? n - 1 : index - 1;
+    size_t next = index + 1 == n ? 0 : index + 1;
+    count_turn(prev, -1);
+    count_turn(index, -1);
+    count_turn(next, -1);
+    count_edge(prev, index, -1);
+    count_edge(index, next, -1);
+    points.erase(points.begin() + index);
+    prev = index == 0 ? n - 2 : index - 1;
+    next = index + 1 == n ? 0 : index;
+    count_edge(prev, next, 1);
+    count_turn(prev, 1);
+    count_turn(next, 1);
+    bounding_box_.reset();
+    bounding_circle_.reset();
+    end_edit();
+}
+
+void Polygon::moveVertex(size_t index, const Point& point) {
+    size_t n = points.size();
+    if (!allows(Edit::Move)) throw std::logic_error("Polygon::moveVertex: the shape's type fixes its vertices");
+    if (index >= n) throw std::out_of_range("Polygon::moveVertex: index out of range");
+    if (n < 3) {
+        points[index] = point;
+        *this = Polygon(std::span<const Point>(points), points.get_allocator().resource());
+        return;
+    }
+    begin_edit();
+    size_t prev = index == 0 ? n - 1 : index - 1;
+    size_t next = index + 1 == n ? 0 : index + 1;
+    for (size_t i : {prev, index, next}) {
+        count_turn(i, -1);
+    }
+    count_edge(prev, index, -1);
+    count_edge(index, next, -1);
+    points[index] = point;
+    count_edge(prev, index, 1);
+    count_edge(index, next, 1);
+    for (size_t i : {prev, index, next}) {
+        count_turn(i, 1);
+    }
+    bounding_box_.reset();
+    bounding_circle_.reset();
+    end_edit();
+}
+
+const Polygon::Triangulation& Polygon::triangulation_cache() const {
+    if (!triangulation_) {
+        triangulation_ = Triangulation();
+        std::optional<std::vector<std::array<size_t, 3>>> triangles = Geometry::triangulate(points);
+        triangulation_->simple = triangles.has_value();
+        if (triangles) {
+            triangulation_->triangles = std::move(*triangles);
+            double total = 0;
+            for (const auto& t : triangulation_->triangles) {
+                total += fabs((points[t[1]] - points[t[0]]).crossProduct(points[t[2]] - points[t[0]])) / 2;
+                triangulation_->cumulative_area.push_back(total);
+            }
+        }
+    }
+    return *triangulation_;
+}
+
+const std::vector<std::array<size_t, 3>>& Polygon::triangulation() const {
+    const Triangulation& cache = triangulation_cache();
+    if (!cache.simple) throw std::invalid_argument("Polygon::triangulation: polygon is not simple");
+    return cache.triangles;
+}
+
+size_t Polygon::build_triangle_tree(size_t first, size_t last) const {
+    static const size_t leaf_size = 4;
+    Triangulation& cache = *triangulation_;
+    size_t node = cache.tree.size();
+    cache.tree.push_back({BoundingBox(), 0, first, 0});
+    BoundingBox centers;
+    for (size_t i = first; i < last; ++i) {
+        const auto& t = cache.triangles[cache.items[i]];
+        for (size_t corner : t) {
+            cache.tree[node].box.extend(points[corner]);
+        }
+        centers.extend((points[t[0]] + points[t[1]] + points[t[2]]) / 3);
+    }
+    cache.tree[node].box = BoundingBox(cache.tree[node].box.lower - Point(eps, eps), cache.tree[node].box.upper + Point(eps, eps));
+    if (last - first <= leaf_size) {
+        cache.tree[node].count = last - first;
+        return node;
+    }
+    bool by_x = centers.upper.x - centers.lower.x >= centers.upper.y - centers.lower.y;
+    size_t middle = first + (last - first) / 2;
+    std::nth_element(cache.items.begin() + first, cache.items.begin() + middle, cache.items.begin() + last,
+                     [&](size_t lhs, size_t rhs) {
+        const auto& l = cache.triangles[lhs];
+        const auto& r = cache.triangles[rhs];
+        Point lc = points[l[0]] + points[l[1]] + points[l[2]];
+        Point rc = points[r[0]] + points[r[1]] + points[r[2]];
+        return by_x ? lc.x < rc.x : lc.y < rc.y;
+    });
+    build_triangle_tree(first, middle);
+    size_t right = build_triangle_tree(middle, last);
+    cache.tree[node].right = right;
+    return node;
+}
+
+// builds the tree over the cached triangulation if it is missing
+void Polygon::triangle_tree() const {
+    Triangulation& cache = *triangulation_;
+    if (cache.triangles.empty() || !cache.tree.empty()) return;
+    cache.items.resize(cache.triangles.size());
+    std::iota(cache.items.begin(), cache.items.end(), 0);
+    build_triangle_tree(0, cache.items.size());
+}
+
+bool Polygon::triangulation_contains(const Point& point) const {
+    const Triangulation& cache = *triangulation_;
+    if (cache.triangles.empty()) return false;
+    triangle_tree();
+    size_t stack[64];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top) {
+        size_t index = stack[--top];
+        const Triangulation::Node& node = cache.tree[index];
+        if (!node.box.containsPoint(point)) continue;
+        if (!node.count) {
+            stack[top++] = node.right;
+            stack[top++] = index + 1;
+            continue;
+        }
+        for (size_t i = node.first; i < node.first + node.count; ++i) {
+            const auto& t = cache.triangles[cache.items[i]];
+            const Point& a = points[t[0]];
+            const Point& b = points[t[1]];
+            const Point& c = points[t[2]];
+            int sign = Geometry::orientation(a, b, c);
+            if (sign == 0) continue;
+            if (sign * (b - a).crossProduct(point - a) >= -eps && sign * (c - b).crossProduct(point - b) >= -eps
+                && sign * (a - c).crossProduct(point - c) >= -eps) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <typename Generator>
+Point Polygon::randomPoint(Generator& generator) const {
+    const Triangulation& cache = triangulation_cache();
+    if (!cache.simple) throw std::invalid_argument("Polygon::randomPoint: polygon is not simple");
+    if (cache.triangles.empty() || cache.cumulative_area.back() <= 0) {
+        throw std::invalid_argument("Polygon::randomPoint: polygon has no area");
+    }
+    std::uniform_real_distribution<double> unit(0, 1);
+    double target = unit(generator) * cache.cumulative_area.back();
+    size_t k = std::upper_bound(cache.cumulative_area.begin(), cache.cumulative_area.end(), target) - cache.cumulative_area.begin();
+    const auto& t = cache.triangles[std::min(k, cache.triangles.size() - 1)];
+    double r = sqrt(unit(generator));
+    double s = unit(generator);
+    return points[t[0]] * (1 - r) + points[t[1]] * (r * (1 - s)) + points[t[2]] * (r * s);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
+namespace Geometry {
+    // For the triangle a, a + u, a + v: the circumcenter is a + o and the incenter a + i.
+    // With G = a + (u + v) / 3 the orthocenter is 3G - 2O and the nine-point center (3G - O) / 2.
+    void circumcenter_offset(double ux, double uy, double vx, double vy, double& ox, double& oy) {
+        double uu = ux * ux + uy * uy;
+        double vv = vx * vx + vy * vy;
+        double d = 2 * (ux * vy - uy * vx);
+        ox = (vy * uu - uy * vv) / d;
+        oy = (ux * vv - vx * uu) / d;
+    }
+
+    // returns the inradius
+    double incenter_offset(double ux, double uy, double vx, double vy, double& ox, double& oy) {
+        double lu = sqrt(ux * ux + uy * uy);
+        double lv = sqrt(vx * vx + vy * vy);
+        double lw = sqrt((vx - ux) * (vx - ux) + (vy - uy) * (vy - uy));
+        double perimeter = lu + lv + lw;
+        ox = (ux * lv + vx * lu) / perimeter;
+        oy = (uy * lv + vy * lu) / perimeter;
+        return fabs(ux * vy - uy * vx) / perimeter;
+    }
+}
+
 class Triangle : public Polygon {
 public:
     using Polygon::Polygon;
@@ -589,56 +2673,298 @@ public:
 
     Circle inscribedCircle() const;
 
-    Point centroid() const;
-
     Point orthocenter() const;
 
     Line EulerLine() const;
 
     Circle ninePointsCircle() const;
-private:
-    Line bis(Line a, Line b) const;
-};
 
-Point Triangle::centroid() const{
-    return (points[0] + points[1] + points[2]) / 3;
-}
+    void insertVertex(size_t index, const Point& point) = delete;
 
-Line Triangle::bis(Line a, Line b) const{
-    a.norm();
-    b.norm();
-    Line res;
-    res.a = a.a + b.a;
-    res.b = a.b + b.b;
-    res.c = a.c + b.c;
-    return res;
-}
+    void removeVertex(size_t index) = delete;
+
+protected:
+    bool allows(Edit edit) const override { return edit == Edit::Move; }
+};
 
 Circle Triangle::inscribedCircle() const {
-    Line first = bis(Line(points[1], points[0]), Line(points[2], points[0]));
-    Line second = bis(Line(points[0], points[1]), Line(points[2], points[1]));
-    Point center = first * second;
-    return {center, Line(points[0], points[1]).dist(center)};
+    Point u = points[1] - points[0];
+    Point v = points[2] - points[0];
+    Point offset;
+    double radius = Geometry::incenter_offset(u.x, u.y, v.x, v.y, offset.x, offset.y);
+    return {points[0] + offset, radius};
 }
 
 Circle Triangle::circumscribedCircle() const {
-    Line first = Line(points[0], points[1]).perp((points[0] + points[1]) / 2);
-    Line second = Line(points[2], points[1]).perp((points[2] + points[1]) / 2);
-    Point center = first * second;
-    return {center, (center - points[0]).len()};
+    Point u = points[1] - points[0];
+    Point v = points[2] - points[0];
+    Point offset;
+    Geometry::circumcenter_offset(u.x, u.y, v.x, v.y, offset.x, offset.y);
+    return {points[0] + offset, offset.len()};
 }
 
 Circle Triangle::ninePointsCircle() const {
-    Triangle small((points[0] + points[1]) / 2, (points[2] + points[1]) / 2, (points[0] + points[2]) / 2);
-    return small.circumscribedCircle();
+    Point u = points[1] - points[0];
+    Point v = points[2] - points[0];
+    Point offset;
+    Geometry::circumcenter_offset(u.x, u.y, v.x, v.y, offset.x, offset.y);
+    return {points[0] + (u + v - offset) / 2, offset.len() / 2};
 }
 
 Point Triangle::orthocenter() const {
-    Line first = Line(points[0], points[1]).perp(points[2]);
-    Line second = Line(points[0], points[2]).perp(points[1]);
-    return first * second;
+    Point u = points[1] - points[0];
+    Point v = points[2] - points[0];
+    Point offset;
+    Geometry::circumcenter_offset(u.x, u.y, v.x, v.y, offset.x, offset.y);
+    return points[0] + (u + v - offset * 2);
 }
 
 Line Triangle::EulerLine() const {
     return {centroid(), orthocenter()};
 }
+
+// Triangles as a structure of arrays: vertex k of triangle i is (x[k][i], y[k][i]).
+// The batch functions below run over it on all cores, one branch-free loop each.
+struct TriangleArrays {
+    std::array<std::vector<double>, 3> x;
+    std::array<std::vector<double>, 3> y;
+
+    TriangleArrays() = default;
+
+    explicit TriangleArrays(std::span<const Triangle> triangles);
+
+    // an indexed mesh
+    TriangleArrays(std::span<const Point> vertices, std::span<const std::array<size_t, 3>> triangles);
+
+    size_t size() const;
+
+    void push_back(const Point& a, const Point& b, const Point& c);
+};
+
+struct CircleArrays {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> radius;
+};
+
+struct PointArrays {
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+// a x + b y + c = 0, as Line
+struct LineArrays {
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> c;
+};
+
+TriangleArrays::TriangleArrays(std::span<const Triangle> triangles) {
+    for (size_t k = 0; k < 3; ++k) {
+        x[k].resize(triangles.size());
+        y[k].resize(triangles.size());
+    }
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        const std::pmr::vector<Point>& v = triangles[i].getVertices();
+        for (size_t k = 0; k < 3; ++k) {
+            x[k][i] = v[k].x;
+            y[k][i] = v[k].y;
+        }
+    }
+}
+
+TriangleArrays::TriangleArrays(std::span<const Point> vertices, std::span<const std::array<size_t, 3>> triangles) {
+    for (size_t k = 0; k < 3; ++k) {
+        x[k].resize(triangles.size());
+        y[k].resize(triangles.size());
+    }
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        for (size_t k = 0; k < 3; ++k) {
+            if (triangles[i][k] >= vertices.size()) throw std::out_of_range("TriangleArrays: vertex index out of range");
+            x[k][i] = vertices[triangles[i][k]].x;
+            y[k][i] = vertices[triangles[i][k]].y;
+        }
+    }
+}
+
+size_t TriangleArrays::size() const {
+    return x[0].size();
+}
+
+void TriangleArrays::push_back(const Point& a, const Point& b, const Point& c) {
+    x[0].push_back(a.x);
+    y[0].push_back(a.y);
+    x[1].push_back(b.x);
+    y[1].push_back(b.y);
+    x[2].push_back(c.x);
+    y[2].push_back(c.y);
+}
+
+namespace Geometry {
+    // calls kernel(i, ax, ay, ux, uy, vx, vy) for every triangle a, a + u, a + v; the kernels
+    // only do arithmetic on raw arrays, so that the loops vectorize (sqrt needs -fno-math-errno)
+    template <typename Kernel>
+    void triangle_batch(const TriangleArrays& triangles, Kernel kernel) {
+        const double* ax = triangles.x[0].data();
+        const double* ay = triangles.y[0].data();
+        const double* bx = triangles.x[1].data();
+        const double* by = triangles.y[1].data();
+        const double* cx = triangles.x[2].data();
+        const double* cy = triangles.y[2].data();
+        parallel_for(triangles.size(), [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                kernel(i, ax[i], ay[i], bx[i] - ax[i], by[i] - ay[i], cx[i] - ax[i], cy[i] - ay[i]);
+            }
+        }, 1 << 14);
+    }
+}
+
+CircleArrays circumscribedCircles(const TriangleArrays& triangles) {
+    CircleArrays result{std::vector<double>(triangles.size()), std::vector<double>(triangles.size()),
+                        std::vector<double>(triangles.size())};
+    double* x = result.x.data();
+    double* y = result.y.data();
+    double* radius = result.radius.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double ax, double ay, double ux, double uy, double vx, double vy) {
+        double ox, oy;
+        Geometry::circumcenter_offset(ux, uy, vx, vy, ox, oy);
+        x[i] = ax + ox;
+        y[i] = ay + oy;
+        radius[i] = sqrt(ox * ox + oy * oy);
+    });
+    return result;
+}
+
+CircleArrays inscribedCircles(const TriangleArrays& triangles) {
+    CircleArrays result{std::vector<double>(triangles.size()), std::vector<double>(triangles.size()),
+                        std::vector<double>(triangles.size())};
+    double* x = result.x.data();
+    double* y = result.y.data();
+    double* radius = result.radius.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double ax, double ay, double ux, double uy, double vx, double vy) {
+        double ox, oy;
+        radius[i] = Geometry::incenter_offset(ux, uy, vx, vy, ox, oy);
+        x[i] = ax + ox;
+        y[i] = ay + oy;
+    });
+    return result;
+}
+
+CircleArrays ninePointsCircles(const TriangleArrays& triangles) {
+    CircleArrays result{std::vector<double>(triangles.size()), std::vector<double>(triangles.size()),
+                        std::vector<double>(triangles.size())};
+    double* x = result.x.data();
+    double* y = result.y.data();
+    double* radius = result.radius.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double ax, double ay, double ux, double uy, double vx, double vy) {
+        double ox, oy;
+        Geometry::circumcenter_offset(ux, uy, vx, vy, ox, oy);
+        x[i] = ax + (ux + vx - ox) / 2;
+        y[i] = ay + (uy + vy - oy) / 2;
+        radius[i] = sqrt(ox * ox + oy * oy) / 2;
+    });
+    return result;
+}
+
+PointArrays orthocenters(const TriangleArrays& triangles) {
+    PointArrays result{std::vector<double>(triangles.size()), std::vector<double>(triangles.size())};
+    double* x = result.x.data();
+    double* y = result.y.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double ax, double ay, double ux, double uy, double vx, double vy) {
+        double ox, oy;
+        Geometry::circumcenter_offset(ux, uy, vx, vy, ox, oy);
+        x[i] = ax + (ux + vx - 2 * ox);
+        y[i] = ay + (uy + vy - 2 * oy);
+    });
+    return result;
+}
+
+// the line through the centroid and the orthocenter, degenerate for equilateral triangles
+LineArrays EulerLines(const TriangleArrays& triangles) {
+    LineArrays result{std::vector<double>(triangles.size()), std::vector<double>(triangles.size()),
+                      std::vector<double>(triangles.size())};
+    double* a = result.a.data();
+    double* b = result.b.data();
+    double* c = result.c.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double ax, double ay, double ux, double uy, double vx, double vy) {
+        double ox, oy;
+        Geometry::circumcenter_offset(ux, uy, vx, vy, ox, oy);
+        double gx = ax + (ux + vx) / 3;
+        double gy = ay + (uy + vy) / 3;
+        double hx = ax + (ux + vx - 2 * ox);
+        double hy = ay + (uy + vy - 2 * oy);
+        a[i] = hy - gy;
+        b[i] = gx - hx;
+        c[i] = hx * gy - hy * gx;
+    });
+    return result;
+}
+
+// circumradius over inradius, abc (a + b + c) / (2 (u x v)^2); 2 for equilateral triangles,
+// infinite for degenerate ones
+std::vector<double> radiusRatios(const TriangleArrays& triangles) {
+    std::vector<double> result(triangles.size());
+    double* ratio = result.data();
+    Geometry::triangle_batch(triangles, [=](size_t i, double, double, double ux, double uy, double vx, double vy) {
+        double lu = sqrt(ux * ux + uy * uy);
+        double lv = sqrt(vx * vx + vy * vy);
+        double lw = sqrt((vx - ux) * (vx - ux) + (vy - uy) * (vy - uy));
+        double cross = ux * vy - uy * vx;
+        ratio[i] = lu * lv * lw * (lu + lv + lw) / (2 * cross * cross);
+    });
+    return result;
+}
+
+std::vector<Triangle> Polygon::triangles() const {
+    std::vector<Triangle> result;
+    result.reserve(triangulation().size());
+    for (const auto& t : triangulation()) {
+        result.emplace_back(std::initializer_list<Point>{points[t[0]], points[t[1]], points[t[2]]},
+                            points.get_allocator().resource());
+    }
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+namespace Geometry {
+    // Andrew's monotone chain, sorts the points; counterclockwise, without collinear vertices
+    std::vector<Point> monotone_chain(std::vector<Point>& cloud) {
+        std::sort(cloud.begin(), cloud.end(), [](const Point& lhs, const Point& rhs) {
+            return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+        });
+        cloud.erase(std::unique(cloud.begin(), cloud.end(), [](const Point& lhs, const Point& rhs) {
+            return lhs.x == rhs.x && lhs.y == rhs.y;
+        }), cloud.end());
+        if (cloud.size() < 3) return cloud;
+        std::vector<Point> hull(2 * cloud.size());
+        size_t k = 0;
+        for (size_t i = 0; i < cloud.size(); ++i) {
+            while (k >= 2 && orientation(hull[k - 2], hull[k - 1], cloud[i]) <= 0) --k;
+            hull[k++] = cloud[i];
+        }
+        for (size_t i = cloud.size() - 1, lower = k + 1; i > 0; --i) {
+            while (k >= lower && orientation(hull[k - 2], hull[k - 1], cloud[i - 1]) <= 0) --k;
+            hull[k++] = cloud[i - 1];
+        }
+        hull.resize(k - 1);
+        return hull;
+    }
+}
+
+// hulls of chunks are built on all cores, then the hull of their vertices
+Polygon convexHull(std::span<const Point> cloud) {
+    static const size_t grain = 1 << 16;
+    std::vector<Point> candidates;
+    std::mutex guard;
+    Geometry::parallel_for(cloud.size(), [&](size_t first, size_t last) {
+        std::vector<Point> chunk(cloud.begin() + first, cloud.begin() + last);
+        std::vector<Point> hull = Geometry::monotone_chain(chunk);
+        std::lock_guard<std::mutex> lock(guard);
+        candidates.insert(candidates.end(), hull.begin(), hull.end());
+    }, grain);
+    Polygon result(std::pmr::get_default_resource());
+    std::vector<Point> hull = Geometry::monotone_chain(candidates);
+    result.points.assign(hull.begin(), hull.end());
+    result.is_convex = true;
+    return result;
+}
@@ -0,0 +1,278 @@
+// g++ -std=c++20 -O2 -pthread geometry_bench.cpp -o geometry_bench
+// ./geometry_bench [substring]   runs the cases whose name contains the substring
+// Prints one JSON object per case: name, size, items processed per repetition,
+// repetitions and mean time per repetition in nanoseconds. Every case draws its
+// inputs from its own fixed seed, so runs and filtered runs see the same data.
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include "geometry.h"
+
+std::string filter;
+
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+template <typename Function>
+void measure(const std::string& name, size_t size, size_t items, Function function) {
+    if (name.find(filter) == std::string::npos) return;
+    using clock = std::chrono::steady_clock;
+    auto run = [&] {
+        if constexpr (std::is_void_v<decltype(function())>) {
+            function();
+        } else {
+            keep(function());
+        }
+    };
+    run();
+    // the clock is read once per round, so that cheap calls are not dominated by it
+    size_t repetitions = 1;
+    clock::duration elapsed;
+    while (true) {
+        auto start = clock::now();
+        for (size_t i = 0; i < repetitions; ++i) {
+            run();
+        }
+        elapsed = clock::now() - start;
+        if (repetitions >= 3 && elapsed >= std::chrono::milliseconds(200)) break;
+        repetitions *= 2;
+    }
+    double mean = std::chrono::duration<double, std::nano>(elapsed).count() / repetitions;
+    std::cout << "{\"name\": \"" << name << "\", \"size\": " << size << ", \"items\": " << items
+              << ", \"repetitions\": " << repetitions << ", \"mean_ns\": " << mean << "}" << std::endl;
+}
+
+template <typename Function>
+void measure(const std::string& name, size_t size, Function function) {
+    measure(name, size, 1, function);
+}
+
+std::vector<Point> random_cloud(size_t count, std::mt19937_64& random) {
+    std::normal_distribution<double> coordinate(0, 1000);
+    std::vector<Point> cloud(count);
+    for (Point& p : cloud) {
+        p = {coordinate(random), coordinate(random)};
+    }
+    return cloud;
+}
+
+// vertices at sorted random angles; convex on a circle, star-shaped with random radii
+std::vector<Point> random_polygon(size_t count, bool convex, std::mt19937_64& random) {
+    std::uniform_real_distribution<double> angle(0, 2 * Shape::pi);
+    std::uniform_real_distribution<double> radius(100, 1000);
+    std::vector<double> angles(count);
+    for (double& a : angles) {
+        a = angle(random);
+    }
+    std::sort(angles.begin(), angles.end());
+    std::vector<Point> vertices(count);
+    for (size_t i = 0; i < count; ++i) {
+        double r = convex ? 1000 : radius(random);
+        vertices[i] = {r * cos(angles[i]), r * sin(angles[i])};
+    }
+    return vertices;
+}
+
+std::unique_ptr<Shape> random_shape(const std::string& kind, size_t size, std::mt19937_64& random) {
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    auto point = [&] { return Point(coordinate(random), coordinate(random)); };
+    if (kind == "convex_polygon") return std::make_unique<Polygon>(random_polygon(size, true, random));
+    if (kind == "star_polygon") return std::make_unique<Polygon>(random_polygon(size, false, random));
+    if (kind == "triangle") return std::make_unique<Triangle>(point(), point(), point());
+    if (kind == "rectangle") return std::make_unique<Rectangle>(point(), point(), 0.5);
+    if (kind == "square") return std::make_unique<Square>(point(), point());
+    if (kind == "circle") return std::make_unique<Circle>(point(), 500);
+    Point focus = point();
+    return std::make_unique<Ellipse>(focus, focus + Point(300, 400), 1500);
+}
+
+std::vector<Point> queries_in(const BoundingBox& box, size_t count, std::mt19937_64& random) {
+    std::uniform_real_distribution<double> x(box.lower.x, box.upper.x);
+    std::uniform_real_distribution<double> y(box.lower.y, box.upper.y);
+    std::vector<Point> queries(count);
+    for (Point& q : queries) {
+        q = {x(random), y(random)};
+    }
+    return queries;
+}
+
+void shape_cases(const std::string& kind, size_t size) {
+    static const size_t batch = 1024;
+    auto make = [&] {
+        std::mt19937_64 random(20240101 + size);
+        return random_shape(kind, size, random);
+    };
+    std::mt19937_64 random(20240101 + size);
+    std::unique_ptr<Shape> shape = make();
+    std::unique_ptr<Shape> copy = make();
+    std::unique_ptr<Shape> twin = make();
+    twin->apply(AffineTransform::rotation(Point(1, 2), 30));
+    std::unique_ptr<Shape> image = make();
+    image->apply(AffineTransform::rotation(Point(1, 2), 30).scale(Point(-3, 4), 2));
+    std::vector<Point> queries = queries_in(shape->boundingBox(), batch, random);
+    std::string prefix = kind + "/";
+    const Shape& s = *shape;
+
+    measure(prefix + "perimeter", size, [&] { return s.perimeter(); });
+    measure(prefix + "area", size, [&] { return s.area(); });
+    measure(prefix + "boundingBox", size, [&] { return s.boundingBox(); });
+    measure(prefix + "boundingCircle", size, [&] { return s.boundingCircle(); });
+    measure(prefix + "centroid", size, [&] { return s.centroid(); });
+    measure(prefix + "operator==", size, [&] { return s == *copy; });
+    measure(prefix + "isCongruentTo", size, [&] { return s.isCongruentTo(*twin); });
+    measure(prefix + "isSimilarTo", size, [&] { return s.isSimilarTo(*image); });
+    measure(prefix + "containsPoint", size, batch, [&] {
+        size_t inside = 0;
+        for (const Point& q : queries) {
+            inside += s.containsPoint(q);
+        }
+        return inside;
+    });
+
+    // the kernels behind the cached polygon quantities, and the batch queries
+    if (const Polygon* polygon = dynamic_cast<const Polygon*>(shape.get())) {
+        std::span<const Point> vertices(polygon->getVertices());
+        measure(prefix + "area_uncached", size, [&] { return Geometry::polygon_area(vertices); });
+        measure(prefix + "perimeter_uncached", size, [&] { return Geometry::polygon_perimeter(vertices); });
+        measure(prefix + "convexity_uncached", size, [&] { return Geometry::polygon_convex(vertices); });
+        measure(prefix + "boundingCircle_uncached", size, [&] { return Geometry::enclosing_circle(vertices); });
+        measure(prefix + "containsPoints", size, batch, [&] { return polygon->containsPoints(queries); });
+        measure(prefix + "triangulate", size, [&] { return Geometry::triangulate(vertices); });
+        measure(prefix + "simplify_douglas_peucker", size, [&] {
+            return polygon->simplify(Polygon::Simplification::DouglasPeucker, 10, true);
+        });
+        measure(prefix + "simplify_visvalingam_whyatt", size, [&] {
+            return polygon->simplify(Polygon::Simplification::VisvalingamWhyatt, 1000, true);
+        });
+    }
+    if (const Ellipse* ellipse = dynamic_cast<const Ellipse*>(shape.get())) {
+        measure(prefix + "containsPoints", size, batch, [&] { return ellipse->containsPoints(queries); });
+    }
+
+    measure(prefix + "rotate", size, [&] { shape->rotate(Point(1, 1), 1); });
+    measure(prefix + "reflect_point", size, [&] { shape->reflect(Point(1, 1)); });
+    measure(prefix + "reflect_line", size, [&] { shape->reflect(Line(Point(0, 1), Point(2, 3))); });
+    bool grow = true;
+    measure(prefix + "scale", size, [&] {
+        shape->scale(Point(1, 1), grow ? 1.5 : 1 / 1.5);
+        grow = !grow;
+    });
+    AffineTransform shear(1, 0.25, 0, 1, 0, 0);
+    AffineTransform unshear(1, -0.25, 0, 1, 0, 0);
+    measure(prefix + "apply", size, [&] {
+        shape->apply(grow ? shear : unshear);
+        grow = !grow;
+    });
+}
+
+void triangle_cases(size_t count) {
+    std::mt19937_64 random(20240102);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i < count; ++i) {
+        triangles.emplace_back(Point(coordinate(random), coordinate(random)), Point(coordinate(random), coordinate(random)),
+                               Point(coordinate(random), coordinate(random)));
+    }
+    auto each = [&](const char* name, auto center) {
+        measure(std::string("triangle_centers/") + name, 3, count, [&] {
+            double sum = 0;
+            for (const Triangle& t : triangles) {
+                sum += center(t);
+            }
+            return sum;
+        });
+    };
+    each("centroid", [](const Triangle& t) { return t.centroid().x; });
+    each("circumscribedCircle", [](const Triangle& t) { return t.circumscribedCircle().center().x; });
+    each("inscribedCircle", [](const Triangle& t) { return t.inscribedCircle().center().x; });
+    each("ninePointsCircle", [](const Triangle& t) { return t.ninePointsCircle().center().x; });
+    each("orthocenter", [](const Triangle& t) { return t.orthocenter().x; });
+    each("EulerLine", [](const Triangle& t) { return t.EulerLine().a; });
+}
+
+// the structure-of-arrays kernels over a large mesh
+void triangle_batch_cases(size_t count) {
+    std::mt19937_64 random(20240104);
+    std::uniform_real_distribution<double> coordinate(-1000, 1000);
+    TriangleArrays triangles;
+    for (size_t i = 0; i < count; ++i) {
+        triangles.push_back(Point(coordinate(random), coordinate(random)), Point(coordinate(random), coordinate(random)),
+                            Point(coordinate(random), coordinate(random)));
+    }
+    measure("triangle_batch/circumscribedCircles", count, count, [&] { return circumscribedCircles(triangles); });
+    measure("triangle_batch/inscribedCircles", count, count, [&] { return inscribedCircles(triangles); });
+    measure("triangle_batch/ninePointsCircles", count, count, [&] { return ninePointsCircles(triangles); });
+    measure("triangle_batch/orthocenters", count, count, [&] { return orthocenters(triangles); });
+    measure("triangle_batch/EulerLines", count, count, [&] { return EulerLines(triangles); });
+    measure("triangle_batch/radiusRatios", count, count, [&] { return radiusRatios(triangles); });
+}
+
+// virtual calls over a shuffled mix of every kind, small and mid-sized polygons
+void mixed_cases(size_t count) {
+    static const char* kinds[] = {"convex_polygon", "star_polygon", "triangle", "rectangle", "square", "circle", "ellipse"};
+    std::mt19937_64 random(20240103);
+    std::uniform_int_distribution<size_t> kind(0, std::size(kinds) - 1);
+    std::uniform_int_distribution<size_t> vertices(8, 64);
+    std::vector<std::unique_ptr<Shape>> shapes;
+    for (size_t i = 0; i < count; ++i) {
+        shapes.push_back(random_shape(kinds[kind(random)], vertices(random), random));
+    }
+    std::vector<Point> queries = queries_in(BoundingBox(Point(-1000, -1000), Point(1000, 1000)), count, random);
+    measure("mixed/area", count, count, [&] {
+        double sum = 0;
+        for (const auto& shape : shapes) {
+            sum += shape->area();
+        }
+        return sum;
+    });
+    measure("mixed/perimeter", count, count, [&] {
+        double sum = 0;
+        for (const auto& shape : shapes) {
+            sum += shape->perimeter();
+        }
+        return sum;
+    });
+    measure("mixed/containsPoint", count, count, [&] {
+        size_t inside = 0;
+        for (size_t i = 0; i < count; ++i) {
+            inside += shapes[i]->containsPoint(queries[i]);
+        }
+        return inside;
+    });
+    measure("mixed/rotate", count, count, [&] {
+        for (const auto& shape : shapes) {
+            shape->rotate(Point(0, 0), 1);
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) filter = argv[1];
+    std::mt19937_64 random(20240101);
+    for (size_t count : {size_t(1) << 14, size_t(1) << 18, size_t(1) << 22}) {
+        std::vector<Point> cloud = random_cloud(count, random);
+        measure("convex_hull_sequential", count, [&] {
+            std::vector<Point> copy = cloud;
+            return Geometry::monotone_chain(copy);
+        });
+        measure("convex_hull_parallel", count, [&] {
+            return convexHull(cloud);
+        });
+    }
+    for (const char* kind : {"convex_polygon", "star_polygon"}) {
+        for (size_t size : {8, 64, 1024, 16384}) {
+            shape_cases(kind, size);
+        }
+    }
+    shape_cases("triangle", 3);
+    shape_cases("rectangle", 4);
+    shape_cases("square", 4);
+    shape_cases("circle", 0);
+    shape_cases("ellipse", 0);
+    triangle_cases(1024);
+    triangle_batch_cases(size_t(1) << 20);
+    mixed_cases(4096);
+}
@@ -0,0 +1,975 @@
+// g++ -std=c++20 -O2 -pthread geometry_test.cpp -o geometry_test && ./geometry_test
+// Exits with a failed assertion if a shape query disagrees with its reference computation.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "geometry.h"
+#include "polygonio.h"
+
+// Reports eight hardware threads whatever the machine has, so the parallel algorithms really
+// split their input. Geometry::parallel_for asks std::thread, and the definition here takes
+// precedence over the library's.
+unsigned int std::thread::hardware_concurrency() noexcept {
+    return 8;
+}
+
+std::vector<Point> regular(size_t n, const Point& center, double radius) {
+    std::vector<Point> v;
+    for (size_t i = 0; i < n; ++i) {
+        double angle = 2 * Shape::pi * double(i) / double(n);
+        v.push_back(center + Point(cos(angle), sin(angle)) * radius);
+    }
+    return v;
+}
+
+// Points just off every edge, on either side, at distances the eps edge test accepts for small
+// polygons. Every containsPoint path must agree with the plain winding number.
+void boundary_tolerance() {
+    std::vector<std::vector<Point>> polygons = {
+        {Point(0, 0), Point(1e-3, 0), Point(1e-3, 1e-3), Point(0, 1e-3)},
+        regular(7, Point(0.5, 0.5), 2e-4),
+        regular(100, Point(0, 0), 3e-3),
+        {Point(0, 0), Point(4, 0), Point(4, 4), Point(2, 1), Point(0, 4)},
+    };
+    for (const std::vector<Point>& v : polygons) {
+        Polygon polygon(v);
+        PolygonView view(v);
+        std::vector<Point> queries;
+        for (size_t i = 0; i < v.size(); ++i) {
+            Point a = v[i];
+            Point b = v[(i + 1) % v.size()];
+            Point along = b - a;
+            Point normal = Point(along.y, -along.x) / along.len();
+            for (double t : {0.25, 0.5}) {
+                for (double offset : {1e-9, 1e-7, 1e-5, 1e-4, 1e-3}) {
+                    queries.push_back(a + along * t + normal * offset);
+                    queries.push_back(a + along * t - normal * offset);
+                }
+            }
+        }
+        queries.push_back(Point(5e-4, -1e-5));
+        std::vector<bool> batch = polygon.containsPoints(queries);
+        for (size_t j = 0; j < queries.size(); ++j) {
+            bool expected = Geometry::polygon_contains(v, queries[j]);
+            assert(polygon.containsPoint(queries[j]) == expected);
+            assert(view.containsPoint(queries[j]) == expected);
+            assert(batch[j] == expected);
+        }
+    }
+    Polygon square({Point(0, 0), Point(1e-3, 0), Point(1e-3, 1e-3), Point(0, 1e-3)});
+    assert(square.containsPoint(Point(5e-4, -1e-5)));
+}
+
+// the O(log n) fan search agrees with the winding number for both orientations, inside,
+// outside and next to the boundary
+void convex_fan() {
+    std::mt19937 random(28);
+    std::uniform_real_distribution<double> coordinate(-1.2, 1.2);
+    for (size_t n : {3, 4, 5, 17, 256}) {
+        std::vector<Point> v = regular(n, Point(0, 0), 1);
+        for (bool clockwise : {false, true}) {
+            if (clockwise) std::reverse(v.begin(), v.end());
+            Polygon polygon(v);
+            std::vector<Point> queries(v.begin(), v.end());
+            for (int j = 0; j < 2000; ++j) {
+                queries.push_back(Point(coordinate(random), coordinate(random)));
+            }
+            for (size_t i = 0; i < v.size(); ++i) {
+                Point middle = (v[i] + v[(i + 1) % v.size()]) / 2;
+                queries.push_back(middle * (1 + 1e-9));
+                queries.push_back(middle * (1 + 1e-6));
+            }
+            std::vector<bool> batch = polygon.containsPoints(queries);
+            for (size_t j = 0; j < queries.size(); ++j) {
+                bool expected = Geometry::polygon_contains(v, queries[j]);
+                assert(polygon.containsPoint(queries[j]) == expected);
+                assert(batch[j] == expected);
+            }
+        }
+    }
+}
+
+// With tolerance 1 the relation is not transitive: 0.6 matching 1.2 within first led the failure
+// function of Knuth-Morris-Pratt to skip the shift by two, which matches token by token.
+void tolerant_cyclic_shift() {
+    auto eq = [](double a, double b) { return std::fabs(a - b) < 1; };
+    std::vector<double> first = {1.2, 2.4, 0.6};
+    std::vector<double> second = {2.4, 0.6, 1.65};
+    assert(Geometry::cyclic_shift(first, second, eq));
+    std::vector<double> other = {2.4, 2.4, 0.6};
+    assert(!Geometry::cyclic_shift(first, other, eq));
+    assert(Geometry::cyclic_shift(std::vector<double>(), std::vector<double>(), eq));
+}
+
+// similarity ignores the starting vertex, the orientation and any similarity transform
+void similarity() {
+    std::mt19937 random(31);
+    std::uniform_real_distribution<double> radius(1, 2);
+    std::vector<Point> v;
+    for (size_t i = 0; i < 40; ++i) {
+        double angle = 2 * Shape::pi * double(i) / 40;
+        v.push_back(Point(cos(angle), sin(angle)) * radius(random));
+    }
+    Polygon polygon(v);
+    std::vector<Point> rotated(v.begin() + 13, v.end());
+    rotated.insert(rotated.end(), v.begin(), v.begin() + 13);
+    Polygon shifted(rotated);
+    assert(polygon == shifted && polygon.isCongruentTo(shifted));
+
+    Polygon image(v);
+    image.apply(AffineTransform::rotation(Point(3, -1), 70).scale(Point(0, 5), 2.5));
+    image.reflect(Line(Point(0, 0), Point(1, 2)));
+    assert(polygon.isSimilarTo(image) && image.isSimilarTo(polygon));
+    assert(!polygon.isCongruentTo(image));
+    assert(!(polygon == image));
+
+    Polygon moved(v);
+    moved.rotate(Point(7, 7), 123);
+    assert(polygon.isCongruentTo(moved));
+    assert(polygon.similarityHash() == moved.similarityHash());
+
+    std::vector<Point> bent = v;
+    bent[17] = bent[17] * 1.01;
+    Polygon perturbed(bent);
+    assert(!polygon.isSimilarTo(perturbed));
+    assert(!polygon.isSimilarTo(Polygon(std::vector<Point>(v.begin(), v.end() - 1))));
+    assert(!polygon.isSimilarTo(Circle(Point(0, 0), 1)));
+}
+
+// area, perimeter and convexity kept up by the edits match a polygon built from scratch
+void vertex_edits() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> coordinate(-10, 10);
+    Polygon polygon(regular(12, Point(0, 0), 5));
+    polygon.area();
+    for (int step = 0; step < 300; ++step) {
+        size_t n = polygon.verticesCount();
+        Point p(coordinate(random), coordinate(random));
+        switch (random() % 3) {
+            case 0:
+                polygon.insertVertex(random() % (n + 1), p);
+                break;
+            case 1:
+                if (n > 3) polygon.removeVertex(random() % n);
+                break;
+            default:
+                polygon.moveVertex(random() % n, p);
+        }
+        const std::pmr::vector<Point>& v = polygon.getVertices();
+        Polygon fresh(std::vector<Point>(v.begin(), v.end()));
+        assert(std::fabs(polygon.area() - fresh.area()) < 1e-9 * (1 + fresh.area()));
+        assert(std::fabs(polygon.perimeter() - fresh.perimeter()) < 1e-9 * fresh.perimeter());
+        assert(polygon.isConvex() == fresh.isConvex());
+    }
+    bool thrown = false;
+    try {
+        polygon.removeVertex(polygon.verticesCount());
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// the edits a subclass deletes are refused at run time through a Polygon& as well
+void fixed_vertices() {
+    auto refuses = [](auto edit) {
+        try {
+            edit();
+        } catch (const std::logic_error&) {
+            return true;
+        }
+        return false;
+    };
+    Triangle triangle(Point(0, 0), Point(4, 0), Point(0, 3));
+    Polygon& as_polygon = triangle;
+    assert(refuses([&] { as_polygon.insertVertex(1, Point(2, -1)); }));
+    assert(refuses([&] { as_polygon.removeVertex(0); }));
+    assert(triangle.verticesCount() == 3);
+    as_polygon.moveVertex(2, Point(0, 6));
+    assert(std::fabs(triangle.area() - 12) < 1e-9);
+
+    Square square(Point(0, 0), Point(2, 2));
+    Polygon& square_polygon = square;
+    assert(refuses([&] { square_polygon.insertVertex(0, Point(5, 5)); }));
+    assert(refuses([&] { square_polygon.removeVertex(0); }));
+    assert(refuses([&] { square_polygon.moveVertex(0, Point(5, 5)); }));
+    assert(square.verticesCount() == 4 && std::fabs(square.area() - 4) < 1e-9);
+}
+
+// composition applies right to left, the fluent builders prepend, and apply maps a polygon
+// vertex by vertex and an ellipse onto the image of its boundary
+void affine_transforms() {
+    AffineTransform shear(1, 0.5, 0, 1, 2, -1);
+    AffineTransform turn = AffineTransform::rotation(Point(1, 2), 30);
+    AffineTransform mirror = AffineTransform::reflection(Line(Point(0, 0), Point(1, 1)));
+    AffineTransform built = shear;
+    built.rotate(Point(1, 2), 30).reflect(Line(Point(0, 0), Point(1, 1)));
+    for (const Point& p : regular(5, Point(3, -1), 2)) {
+        Point expected = mirror(turn(shear(p)));
+        assert((built(p) - expected).len() < 1e-9);
+        assert(((mirror * turn * shear)(p) - expected).len() < 1e-9);
+    }
+    assert(turn.isSimilarity() && mirror.isSimilarity() && !shear.isSimilarity());
+    assert(std::fabs(turn.determinant() - 1) < 1e-12 && std::fabs(mirror.determinant() + 1) < 1e-12);
+    assert(std::fabs(AffineTransform::scaling(Point(4, 4), -3).similarityRatio() - 3) < 1e-12);
+
+    std::vector<Point> v = regular(6, Point(1, 1), 3);
+    Polygon polygon(v);
+    double area = polygon.area();
+    polygon.apply(shear);
+    for (size_t i = 0; i < v.size(); ++i) {
+        assert((polygon.getVertices()[i] - shear(v[i])).len() < 1e-9);
+    }
+    assert(std::fabs(polygon.area() - area * std::fabs(shear.determinant())) < 1e-9);
+
+    Ellipse ellipse(Point(-2, 0), Point(2, 0), 6);
+    std::vector<Point> boundary;
+    for (size_t i = 0; i < 12; ++i) {
+        double angle = 2 * Shape::pi * double(i) / 12;
+        boundary.push_back(Point(3 * cos(angle), sqrt(5) * sin(angle)));
+    }
+    ellipse.apply(shear);
+    assert(std::fabs(ellipse.area() - Shape::pi * 3 * sqrt(5) * std::fabs(shear.determinant())) < 1e-9);
+    for (const Point& p : boundary) {
+        Point q = shear(p);
+        Point outward = q - ellipse.center();
+        assert(ellipse.containsPoint(q - outward * 1e-6));
+        assert(!ellipse.containsPoint(q + outward * 1e-6));
+    }
+}
+
+// winding number by summing the angles each edge subtends, as the old containsPoint did
+bool angle_sum_contains(const std::vector<Point>& v, const Point& point) {
+    double sum = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        Point a = v[i] - point;
+        Point b = v[(i + 1) % v.size()] - point;
+        sum += atan2(a.x * b.y - a.y * b.x, a.x * b.x + a.y * b.y);
+    }
+    return std::fabs(sum) > Shape::pi;
+}
+
+// the cross-product winding number and the blocked batch agree with the angle sum on a
+// concave polygon, a self-intersecting star and a many-vertex polygon; vertices and edge
+// midpoints count as inside
+void winding_number() {
+    std::vector<Point> star;
+    std::vector<Point> tips = regular(5, Point(0, 0), 4);
+    for (size_t i = 0; i < 5; ++i) {
+        star.push_back(tips[i * 2 % 5]);
+    }
+    std::vector<Point> jagged = regular(300, Point(1, -1), 5);
+    for (size_t i = 0; i < jagged.size(); i += 2) {
+        jagged[i] = Point(1, -1) + (jagged[i] - Point(1, -1)) * 0.6;
+    }
+    std::vector<std::vector<Point>> polygons = {
+        {Point(0, 0), Point(6, 0), Point(6, 6), Point(3, 1), Point(0, 6)},
+        star,
+        jagged,
+    };
+    std::mt19937 gen(27);
+    std::uniform_real_distribution<double> coord(-6, 6);
+    for (const std::vector<Point>& v : polygons) {
+        Polygon polygon(v);
+        std::vector<Point> queries(1000);
+        for (Point& q : queries) {
+            q = Point(coord(gen), coord(gen));
+        }
+        std::vector<bool> batch = polygon.containsPoints(queries);
+        assert(batch.size() == queries.size());
+        for (size_t j = 0; j < queries.size(); ++j) {
+            bool expected = angle_sum_contains(v, queries[j]);
+            assert(polygon.containsPoint(queries[j]) == expected);
+            assert(batch[j] == expected);
+        }
+        std::vector<Point> boundary;
+        for (size_t i = 0; i < v.size(); ++i) {
+            boundary.push_back(v[i]);
+            boundary.push_back((v[i] + v[(i + 1) % v.size()]) / 2);
+        }
+        batch = polygon.containsPoints(boundary);
+        for (size_t j = 0; j < boundary.size(); ++j) {
+            assert(polygon.containsPoint(boundary[j]) && batch[j]);
+        }
+    }
+    assert(Polygon(star).containsPoint(Point(0, 0)));
+    assert(Polygon(star).containsPoints(std::span<const Point>()).empty());
+}
+
+// the cached quantities of a transformed shape match those of the same shape built afresh
+void same_caches(const Shape& cached, const Shape& fresh) {
+    assert(std::fabs(cached.area() - fresh.area()) < 1e-9);
+    assert(std::fabs(cached.perimeter() - fresh.perimeter()) < 1e-9);
+    assert((cached.centroid() - fresh.centroid()).len() < 1e-9);
+    assert((cached.boundingBox().lower - fresh.boundingBox().lower).len() < 1e-9);
+    assert((cached.boundingBox().upper - fresh.boundingBox().upper).len() < 1e-9);
+    assert((cached.boundingCircle().center - fresh.boundingCircle().center).len() < 1e-6);
+    assert(std::fabs(cached.boundingCircle().radius - fresh.boundingCircle().radius) < 1e-6);
+}
+
+// caches filled by precompute() stay correct through every kind of transform and edit
+void cached_quantities() {
+    std::vector<AffineTransform> transforms = {
+        AffineTransform::rotation(Point(1, 2), 37),
+        AffineTransform::scaling(Point(-1, 0), 2.5),
+        AffineTransform::reflection(Line(Point(0, 1), Point(2, 2))),
+        AffineTransform(0, 2, -3, 0, 1, 1),
+        AffineTransform(1, 0.7, 0, 1, 0, 0),
+        AffineTransform::reflection(Point(3, 3)),
+    };
+    Polygon polygon({Point(0, 0), Point(5, 0), Point(5, 3), Point(2, 1), Point(0, 4)});
+    Ellipse ellipse(Point(-1, 1), Point(3, 2), 7);
+    polygon.precompute();
+    ellipse.precompute();
+    for (const AffineTransform& transform : transforms) {
+        polygon.apply(transform);
+        ellipse.apply(transform);
+        std::vector<Point> v(polygon.getVertices().begin(), polygon.getVertices().end());
+        same_caches(polygon, Polygon(v));
+        auto [first, second] = ellipse.focuses();
+        same_caches(ellipse, Ellipse(first, second, 2 * ellipse.semiAxes().first));
+        polygon.precompute();
+    }
+    polygon.moveVertex(3, polygon.getVertices()[3] * 0.5);
+    polygon.insertVertex(1, (polygon.getVertices()[0] + polygon.getVertices()[1]) / 2 + Point(0.1, 0.1));
+    std::vector<Point> v(polygon.getVertices().begin(), polygon.getVertices().end());
+    same_caches(polygon, Polygon(v));
+}
+
+// the hull of a cloud spread over several chunks is strictly convex, counterclockwise, made of
+// cloud points and contains the whole cloud; collinear and repeated points add no vertices
+void convex_hull() {
+    std::mt19937 gen(33);
+    std::uniform_real_distribution<double> radius(0, 1);
+    std::uniform_real_distribution<double> angle(0, 2 * Shape::pi);
+    std::vector<Point> cloud;
+    for (size_t i = 0; i < 300000; ++i) {
+        double r = 10 * sqrt(radius(gen));
+        double a = angle(gen);
+        cloud.push_back(Point(r * cos(a), r * sin(a)));
+    }
+    Polygon hull = convexHull(cloud);
+    const auto& v = hull.getVertices();
+    assert(v.size() > 20 && hull.isConvex());
+    for (size_t i = 0; i < v.size(); ++i) {
+        assert(Geometry::orientation(v[i], v[(i + 1) % v.size()], v[(i + 2) % v.size()]) > 0);
+        assert(std::find(cloud.begin(), cloud.end(), v[i]) != cloud.end());
+    }
+    for (const Point& p : cloud) {
+        assert(hull.containsPoint(p));
+    }
+
+    std::vector<Point> grid;
+    for (int x = 0; x <= 400; ++x) {
+        for (int y = 0; y <= 400; ++y) {
+            grid.push_back(Point(x, y));
+            grid.push_back(Point(x, y));
+        }
+    }
+    std::shuffle(grid.begin(), grid.end(), gen);
+    Polygon square = convexHull(grid);
+    assert(square.verticesCount() == 4 && std::fabs(square.area() - 160000) < 1e-6);
+    assert(convexHull(std::vector<Point>{Point(0, 0), Point(1, 1), Point(2, 2)}).verticesCount() == 2);
+    assert(convexHull(std::vector<Point>()).verticesCount() == 0);
+}
+
+// inside, or on the boundary up to rounding; containsPoint rejects points a rounding error past
+// a vertex on the outside of the corner
+bool covers(const Polygon& polygon, const Point& p) {
+    const auto& v = polygon.getVertices();
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (Geometry::segment_distance(p, v[i], v[(i + 1) % v.size()]) < 1e-12) return true;
+    }
+    return polygon.containsPoint(p);
+}
+
+// the O(n + m) convex intersection agrees with clipping for random convex pairs of either
+// orientation, including shared and parallel edges; rectangles overlap by the exact product
+void convex_intersection() {
+    std::mt19937 gen(34);
+    std::uniform_real_distribution<double> coord(-2, 2);
+    std::uniform_real_distribution<double> size(0.5, 3);
+    std::uniform_real_distribution<double> angle(0, 360);
+    for (size_t trial = 0; trial < 500; ++trial) {
+        std::vector<Point> first = regular(3 + trial % 9, Point(coord(gen), coord(gen)), size(gen));
+        std::vector<Point> second = regular(3 + trial % 5, Point(coord(gen), coord(gen)), size(gen));
+        if (trial % 2) std::reverse(first.begin(), first.end());
+        if (trial % 3 == 0) std::reverse(second.begin(), second.end());
+        Polygon lhs(first);
+        Polygon rhs(second);
+        rhs.rotate(rhs.centroid(), angle(gen));
+        double expected = lhs.clip(rhs).area();
+        Polygon meet = lhs.intersection(rhs);
+        assert(std::fabs(meet.area() - expected) < 1e-9);
+        assert(std::fabs(lhs.intersectionArea(rhs) - expected) < 1e-9);
+        assert(std::fabs(rhs.intersectionArea(lhs) - expected) < 1e-9);
+        for (const Point& p : meet.getVertices()) {
+            assert(covers(lhs, p) && covers(rhs, p));
+        }
+    }
+    Polygon square({Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)});
+    Polygon turned({Point(0, 2), Point(0, 0), Point(2, 0), Point(2, 2)});
+    assert(std::fabs(square.intersectionArea(turned) - 4) < 1e-9);
+    Polygon wide({Point(1, -1), Point(5, -1), Point(5, 1.5), Point(1, 1.5)});
+    assert(std::fabs(square.intersectionArea(wide) - 1.5) < 1e-9);
+    assert(std::fabs(square.intersection(wide).area() - 1.5) < 1e-9);
+    Polygon beside({Point(2, 0), Point(3, 0), Point(3, 2), Point(2, 2)});
+    assert(square.intersectionArea(beside) < 1e-9);
+    Polygon far({Point(10, 10), Point(11, 10), Point(11, 11)});
+    assert(square.intersectionArea(far) == 0 && square.intersection(far).verticesCount() == 0);
+
+    Polygon ell({Point(0, 0), Point(4, 0), Point(4, 1), Point(1, 1), Point(1, 4), Point(0, 4)});
+    assert(std::fabs(ell.clip(square).area() - 3) < 1e-9);
+    assert(std::fabs(ell.intersection(square).area() - 3) < 1e-9);
+    assert(std::fabs(square.intersectionArea(ell) - 3) < 1e-9);
+    bool thrown = false;
+    try {
+        ell.intersection(ell);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// float points and lines compare with their own looser tolerances; int64_t points, lines and
+// orientations are exact even where the products overflow 64 bits
+void coordinate_types() {
+    static_assert(std::is_trivially_copyable_v<Point> && std::is_trivially_copyable_v<BasicPoint<int64_t>>);
+    using FloatPoint = BasicPoint<float>;
+    assert(FloatPoint(1, 1) == FloatPoint(1.00005f, 1));
+    assert(!(FloatPoint(1, 1) == FloatPoint(1.001f, 1)));
+    assert(BasicLine<float>(FloatPoint(0, 0), FloatPoint(1, 2)) == BasicLine<float>(FloatPoint(2, 4), FloatPoint(3, 6)));
+    assert(Geometry::orientation(FloatPoint(0, 0), FloatPoint(1, 0), FloatPoint(0.5f, 1e-6f)) > 0);
+
+    using IntPoint = BasicPoint<int64_t>;
+    using IntLine = BasicLine<int64_t>;
+    const int64_t big = int64_t(1) << 61;
+    IntPoint low(-big, -big);
+    IntPoint high(big - 1, big - 1);
+    assert(Geometry::orientation(low, high, IntPoint(1, 1)) == 0);
+    assert(Geometry::orientation(low, high, IntPoint(1, 2)) > 0);
+    assert(Geometry::orientation(low, high, IntPoint(2, 1)) < 0);
+    assert(Geometry::orientation(IntPoint(big, 0), IntPoint(0, big), IntPoint(big - 1, 1)) == 0);
+    assert(IntPoint(3, 4) == IntPoint(3, 4) && !(IntPoint(3, 4) == IntPoint(3, 5)));
+    assert(IntPoint(7, -9) / 2 == IntPoint(3, -4));
+    assert(IntPoint(3, 4).crossProduct(IntPoint(1, 2)) == 2 && IntPoint(3, 4).dotProduct(IntPoint(1, 2)) == 11);
+    assert(IntLine(IntPoint(0, 0), IntPoint(2, 4)) == IntLine(IntPoint(3, 6), IntPoint(1, 2)));
+    assert(!(IntLine(IntPoint(0, 0), IntPoint(2, 4)) == IntLine(IntPoint(0, 1), IntPoint(2, 5))));
+    assert(std::fabs(IntLine(IntPoint(0, 0), IntPoint(4, 0)).dist(IntPoint(1, 3)) - 3) < 1e-12);
+    assert(Point(IntPoint(big, -3)) == Point(double(big), -3));
+}
+
+// the quadratic form agrees with the focal-distance test |p - F1| + |p - F2| <= 2a + eps for
+// random ellipses, circles and needles, and on the confocal ellipses just inside and outside
+// the tolerance
+void ellipse_containment() {
+    std::mt19937 gen(38);
+    std::uniform_real_distribution<double> coord(-10, 10);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (size_t trial = 0; trial < 200; ++trial) {
+        Point first(coord(gen), coord(gen));
+        Point second = trial % 4 == 0 ? first : Point(coord(gen), coord(gen));
+        double focus_dist = (second - first).len();
+        double sum = focus_dist + (trial % 4 == 1 ? 1e-3 : 10 * unit(gen) + 0.1);
+        Ellipse ellipse(first, second, sum);
+        std::vector<Point> queries(600);
+        for (Point& q : queries) {
+            q = ellipse.center() + Point(coord(gen), coord(gen)) * (sum / 15);
+        }
+        std::vector<bool> batch = ellipse.containsPoints(queries);
+        for (size_t j = 0; j < queries.size(); ++j) {
+            double focal = (queries[j] - first).len() + (queries[j] - second).len();
+            if (std::fabs(focal - sum - Shape::eps) < 1e-12 * (sum + 1)) continue;
+            bool expected = focal <= sum + Shape::eps;
+            assert(ellipse.containsPoint(queries[j]) == expected);
+            assert(batch[j] == expected);
+        }
+        Point u = focus_dist == 0 ? Point(1, 0) : (second - first) / focus_dist;
+        Point v(-u.y, u.x);
+        for (double band : {0.4, 0.6}) {
+            double a = sum / 2 + band * Shape::eps;
+            double b = sqrt(a * a - focus_dist * focus_dist / 4);
+            for (size_t k = 0; k < 16; ++k) {
+                double t = 2 * Shape::pi * double(k) / 16;
+                Point p = ellipse.center() + u * (a * cos(t)) + v * (b * sin(t));
+                assert(ellipse.containsPoint(p) == (band < 0.5));
+            }
+        }
+    }
+}
+
+// a comb with teeth up from a bar: each gap between two teeth bottoms out in a merge vertex
+std::vector<Point> comb(size_t teeth) {
+    std::vector<Point> v = {Point(0, 0), Point(double(2 * teeth), 0)};
+    for (size_t i = teeth; i-- > 0;) {
+        v.push_back(Point(double(2 * i + 2), 1 + double(i % 3)));
+        v.push_back(Point(double(2 * i + 1), 1 + double(i % 3)));
+        v.push_back(Point(double(2 * i + 1), 0.5));
+        v.push_back(Point(double(2 * i), 0.5));
+    }
+    return v;
+}
+
+// ear clipping and the monotone sweep both cover the polygon with n - 2 triangles of its
+// orientation that use every edge once and every diagonal twice; random points are spread
+// by area; self-intersecting polygons are refused
+void triangulation() {
+    std::mt19937 gen(39);
+    std::vector<Point> jagged = regular(3000, Point(0, 0), 10);
+    std::uniform_real_distribution<double> shrink(0.3, 1);
+    for (Point& p : jagged) {
+        p = p * shrink(gen);
+    }
+    std::vector<Point> mirrored = comb(40);
+    for (Point& p : mirrored) {
+        p = Point(p.x, -p.y);
+    }
+    std::vector<std::vector<Point>> polygons = {
+        {Point(0, 0), Point(4, 0), Point(4, 4), Point(2, 1), Point(0, 4)},
+        regular(12, Point(1, 1), 2),
+        comb(5),
+        comb(200),
+        mirrored,
+        jagged,
+    };
+    for (const std::vector<Point>& v : polygons) {
+        Polygon polygon(v);
+        const auto& triangles = polygon.triangulation();
+        assert(triangles.size() == v.size() - 2);
+        double doubled = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            doubled += v[i].crossProduct(v[(i + 1) % v.size()]);
+        }
+        int orientation = doubled > 0 ? 1 : -1;
+        double area = 0;
+        std::map<std::pair<size_t, size_t>, int> uses;
+        for (const auto& t : triangles) {
+            assert(Geometry::orientation(v[t[0]], v[t[1]], v[t[2]]) == orientation);
+            area += std::fabs((v[t[1]] - v[t[0]]).crossProduct(v[t[2]] - v[t[0]])) / 2;
+            for (size_t k = 0; k < 3; ++k) {
+                size_t a = t[k];
+                size_t b = t[(k + 1) % 3];
+                ++uses[{std::min(a, b), std::max(a, b)}];
+            }
+            assert(polygon.containsPoint((v[t[0]] + v[t[1]] + v[t[2]]) / 3));
+        }
+        assert(std::fabs(area - polygon.area()) < 1e-9 * polygon.area());
+        for (const auto& [edge, count] : uses) {
+            bool side = edge.second == edge.first + 1 || (edge.first == 0 && edge.second == v.size() - 1);
+            assert(count == (side ? 1 : 2));
+        }
+        std::vector<Triangle> mesh = polygon.triangles();
+        assert(mesh.size() == triangles.size());
+        for (size_t i = 0; i < mesh.size(); ++i) {
+            assert(mesh[i].getVertices()[1] == v[triangles[i][1]]);
+        }
+
+        double left = 0;
+        double middle = (polygon.boundingBox().lower.x + polygon.boundingBox().upper.x) / 2;
+        Polygon half = polygon.clip(Polygon({Point(-1e3, -1e3), Point(middle, -1e3), Point(middle, 1e3), Point(-1e3, 1e3)}));
+        const size_t samples = 20000;
+        for (size_t i = 0; i < samples; ++i) {
+            Point p = polygon.randomPoint(gen);
+            assert(polygon.containsPoint(p));
+            left += p.x < middle;
+        }
+        assert(std::fabs(left / samples - half.area() / polygon.area()) < 0.02);
+
+        BoundingBox box = polygon.boundingBox();
+        std::uniform_real_distribution<double> x(box.lower.x - 1, box.upper.x + 1);
+        std::uniform_real_distribution<double> y(box.lower.y - 1, box.upper.y + 1);
+        for (size_t i = 0; i < 2000; ++i) {
+            Point q(x(gen), y(gen));
+            assert(polygon.containsPoint(q) == Geometry::polygon_contains(v, q));
+        }
+    }
+    Polygon bowtie({Point(0, 0), Point(2, 2), Point(2, 0), Point(0, 2)});
+    bool thrown = false;
+    try {
+        bowtie.triangulation();
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// wide enough for the exact determinants below; __extension__ keeps -Wpedantic quiet
+__extension__ typedef __int128 Exact;
+
+// the sign of an exact integer determinant
+int sign(Exact value) {
+    return (value > 0) - (value < 0);
+}
+
+// points a few ulps from the line through (12, 12) and (24, 24), and from its parallel through
+// the origin, orient as the exact integer cross product says, where plain doubles often do not
+void orientation_predicates() {
+    const double ulp = std::ldexp(1.0, -53);
+    auto exact = [&](double v) { return Exact(std::ldexp(v, 53)); };
+    size_t naive_wrong = 0;
+    for (int i = 0; i < 128; ++i) {
+        for (int j = 0; j < 128; ++j) {
+            double cx = 0.5 + i * ulp;
+            double cy = 0.5 + j * ulp;
+            Exact cross = (exact(24) - exact(12)) * (exact(cy) - exact(12)) - (exact(24) - exact(12)) * (exact(cx) - exact(12));
+            assert(Geometry::orient2d(12, 12, 24, 24, cx, cy) == sign(cross));
+            assert(Geometry::orientation(Point(12, 12), Point(24, 24), Point(cx, cy)) == sign(cross));
+            double naive = (24.0 - 12) * (cy - 12) - (24.0 - 12) * (cx - 12);
+            naive_wrong += ((naive > 0) - (naive < 0)) != sign(cross);
+            Exact parallel = (exact(24) - exact(12)) * (exact(cy) - exact(-0.25)) - (exact(24) - exact(12)) * (exact(cx) - exact(-0.25));
+            assert(Geometry::cross2d(12, 12, 24, 24, -0.25, -0.25, cx, cy) == sign(parallel));
+        }
+    }
+    assert(naive_wrong > 0);
+}
+
+// lattice points on the circle x^2 + y^2 = 5^20, from products of 2 + i and 2 - i
+std::vector<std::pair<int64_t, int64_t>> cocircular() {
+    std::vector<std::pair<int64_t, int64_t>> result;
+    for (int k = 0; k <= 20; ++k) {
+        int64_t x = 1;
+        int64_t y = 0;
+        for (int f = 0; f < 20; ++f) {
+            int64_t b = f < k ? 1 : -1;
+            int64_t nx = 2 * x - b * y;
+            y = 2 * y + b * x;
+            x = nx;
+        }
+        for (auto [px, py] : {std::pair(x, y), std::pair(-y, x), std::pair(-x, -y), std::pair(y, -x)}) {
+            result.push_back({px, py});
+        }
+    }
+    return result;
+}
+
+// four cocircular lattice points, scaled and shifted so no coordinate is an integer, are
+// exactly on the circle; one grid step off they are inside or outside as the integer
+// determinant says
+void incircle_predicate() {
+    std::vector<std::pair<int64_t, int64_t>> lattice = cocircular();
+    std::mt19937 gen(41);
+    std::uniform_int_distribution<size_t> pick(0, lattice.size() - 1);
+    auto coordinate = [](int64_t v) { return std::ldexp(double(v), -20) + 0.5; };
+    for (size_t trial = 0; trial < 2000; ++trial) {
+        std::pair<int64_t, int64_t> p[4];
+        for (auto& q : p) {
+            q = lattice[pick(gen)];
+        }
+        int64_t shift = int64_t(trial % 3) - 1;
+        p[3].first += shift;
+        p[3].second += int64_t(trial % 2) * shift;
+        Exact d[3][3];
+        for (int i = 0; i < 3; ++i) {
+            Exact dx = p[i].first - p[3].first;
+            Exact dy = p[i].second - p[3].second;
+            d[i][0] = dx;
+            d[i][1] = dy;
+            d[i][2] = dx * dx + dy * dy;
+        }
+        Exact det = d[0][2] * (d[1][0] * d[2][1] - d[1][1] * d[2][0]) + d[1][2] * (d[2][0] * d[0][1] - d[2][1] * d[0][0])
+                     + d[2][2] * (d[0][0] * d[1][1] - d[0][1] * d[1][0]);
+        Point points[4];
+        for (int i = 0; i < 4; ++i) {
+            points[i] = Point(coordinate(p[i].first), coordinate(p[i].second));
+        }
+        assert(Geometry::incircle(points[0], points[1], points[2], points[3]) == sign(det));
+        if (shift == 0) assert(sign(det) == 0);
+    }
+}
+
+// positions in v of the vertices of a simplification of v, which keeps a subsequence of them
+std::vector<size_t> kept_indices(const std::vector<Point>& v, const Polygon& simplified) {
+    std::vector<size_t> result;
+    size_t i = 0;
+    for (const Point& p : simplified.getVertices()) {
+        while (i < v.size() && !(v[i].x == p.x && v[i].y == p.y)) ++i;
+        assert(i < v.size());
+        result.push_back(i++);
+    }
+    return result;
+}
+
+// no two edges meet except neighbours at their shared vertex
+bool simple(const std::vector<Point>& v) {
+    size_t n = v.size();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 2; j < n; ++j) {
+            if (i == 0 && j == n - 1) continue;
+            if (Geometry::segments_intersect(v[i], v[i + 1], v[j], v[(j + 1) % n])) return false;
+        }
+    }
+    return true;
+}
+
+// Visvalingam-Whyatt by a quadratic scan, with the same rule that a vertex never counts as
+// smaller than one removed before it
+std::vector<char> slow_visvalingam(const std::vector<Point>& v, double tolerance) {
+    std::vector<size_t> ring(v.size());
+    std::iota(ring.begin(), ring.end(), 0);
+    std::vector<double> floor(v.size(), 0);
+    std::vector<char> keep(v.size(), true);
+    while (ring.size() > 3) {
+        size_t best = 0;
+        double smallest = std::numeric_limits<double>::infinity();
+        for (size_t k = 0; k < ring.size(); ++k) {
+            const Point& a = v[ring[(k + ring.size() - 1) % ring.size()]];
+            const Point& b = v[ring[k]];
+            const Point& c = v[ring[(k + 1) % ring.size()]];
+            double area = std::max(std::fabs((a - b).crossProduct(c - b)) / 2, floor[ring[k]]);
+            if (area < smallest) {
+                smallest = area;
+                best = k;
+            }
+        }
+        if (!(smallest < tolerance)) break;
+        keep[ring[best]] = false;
+        floor[ring[(best + ring.size() - 1) % ring.size()]] = std::max(floor[ring[(best + ring.size() - 1) % ring.size()]], smallest);
+        floor[ring[(best + 1) % ring.size()]] = std::max(floor[ring[(best + 1) % ring.size()]], smallest);
+        ring.erase(ring.begin() + ptrdiff_t(best));
+    }
+    return keep;
+}
+
+// Douglas-Peucker leaves every dropped vertex within tolerance of the shortcut over it,
+// Visvalingam-Whyatt drops what the quadratic scan drops, and the repair pass keeps the
+// result simple and every kept vertex turning as before
+void simplification() {
+    std::mt19937 gen(43);
+    std::uniform_real_distribution<double> shrink(0.3, 1);
+    std::vector<std::vector<Point>> rings;
+    for (size_t n : {10, 120, 600}) {
+        std::vector<Point> v = regular(n, Point(2, -1), 5);
+        for (Point& p : v) {
+            p = Point(2, -1) + (p - Point(2, -1)) * shrink(gen);
+        }
+        rings.push_back(v);
+    }
+    rings.push_back(comb(30));
+    // dropping (5, -0.3) leaves a shortcut along y = 0 that the kept spike at (5, -0.1) crosses
+    rings.push_back({Point(0, 0), Point(5, -0.3), Point(10, 0), Point(9.5, 1), Point(5.2, 1), Point(5, -0.1),
+                     Point(4.8, 1), Point(0.5, 1)});
+    size_t crossed = 0;
+    for (const std::vector<Point>& v : rings) {
+        assert(simple(v));
+        Polygon polygon(v);
+        for (double tolerance : {0.0, 0.05, 0.4, 1.5}) {
+            Polygon dp = polygon.simplify(Polygon::Simplification::DouglasPeucker, tolerance);
+            std::vector<size_t> kept = kept_indices(v, dp);
+            assert(kept.size() >= 3 && kept.size() <= v.size());
+            for (size_t k = 0; k < kept.size(); ++k) {
+                size_t first = kept[k];
+                size_t last = k + 1 < kept.size() ? kept[k + 1] : kept[0] + v.size();
+                for (size_t i = first + 1; i < last; ++i) {
+                    assert(Geometry::segment_distance(v[i % v.size()], v[first], v[last % v.size()]) <= tolerance);
+                }
+            }
+
+            Polygon vw = polygon.simplify(Polygon::Simplification::VisvalingamWhyatt, tolerance);
+            std::vector<char> expected = slow_visvalingam(v, tolerance);
+            std::vector<size_t> vw_kept = kept_indices(v, vw);
+            assert(vw_kept.size() == size_t(std::count(expected.begin(), expected.end(), true)));
+            for (size_t i : vw_kept) {
+                assert(expected[i]);
+            }
+
+            for (Polygon::Simplification method : {Polygon::Simplification::DouglasPeucker, Polygon::Simplification::VisvalingamWhyatt}) {
+                Polygon plain = polygon.simplify(method, tolerance);
+                std::vector<Point> loose(plain.getVertices().begin(), plain.getVertices().end());
+                crossed += !simple(loose);
+                Polygon repaired = polygon.simplify(method, tolerance, true, true);
+                std::vector<Point> w(repaired.getVertices().begin(), repaired.getVertices().end());
+                std::vector<size_t> at = kept_indices(v, repaired);
+                assert(simple(w));
+                for (size_t k = 0; k < w.size(); ++k) {
+                    size_t i = at[k];
+                    int before = Geometry::orientation(v[(i + v.size() - 1) % v.size()], v[i], v[(i + 1) % v.size()]);
+                    int after = Geometry::orientation(w[(k + w.size() - 1) % w.size()], w[k], w[(k + 1) % w.size()]);
+                    assert(before == after);
+                }
+            }
+        }
+    }
+    assert(crossed > 0);
+
+    std::vector<Polygon> batch(rings.begin(), rings.end());
+    std::vector<Polygon> simplified = simplify(batch, Polygon::Simplification::DouglasPeucker, 0.4, true);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Polygon one = batch[i].simplify(Polygon::Simplification::DouglasPeucker, 0.4, true);
+        assert(simplified[i].getVertices() == one.getVertices());
+    }
+    bool thrown = false;
+    try {
+        batch[0].simplify(Polygon::Simplification::VisvalingamWhyatt, -1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// the smallest of the circles through two or three of the points that holds them all
+BoundingCircle slow_enclosing_circle(const std::vector<Point>& v) {
+    BoundingCircle best(Point(0, 0), std::numeric_limits<double>::infinity());
+    auto consider = [&](const Point& center, double radius) {
+        if (radius >= best.radius) return;
+        for (const Point& p : v) {
+            if ((p - center).len() > radius * (1 + 1e-12)) return;
+        }
+        best = BoundingCircle(center, radius);
+    };
+    for (size_t i = 0; i < v.size(); ++i) {
+        for (size_t j = i + 1; j < v.size(); ++j) {
+            consider((v[i] + v[j]) / 2, (v[i] - v[j]).len() / 2);
+            for (size_t k = j + 1; k < v.size(); ++k) {
+                Point u = v[j] - v[i];
+                Point w = v[k] - v[i];
+                double d = 2 * u.crossProduct(w);
+                if (d == 0) continue;
+                Point center = v[i] + Point(w.y * u.dotProduct(u) - u.y * w.dotProduct(w), u.x * w.dotProduct(w) - w.x * u.dotProduct(u)) / d;
+                consider(center, (center - v[i]).len());
+            }
+        }
+    }
+    return best;
+}
+
+// Welzl's circle matches the brute-force minimum, holds every vertex, survives edits and
+// similarity maps, and is the major-axis circle for an ellipse
+void enclosing_circles() {
+    std::mt19937 gen(44);
+    std::uniform_real_distribution<double> coord(-5, 5);
+    for (size_t trial = 0; trial < 200; ++trial) {
+        std::vector<Point> v = trial % 5 == 0 ? regular(3 + trial % 40, Point(coord(gen), coord(gen)), 3) : std::vector<Point>();
+        for (size_t i = v.size(); i < 3 + trial % 25; ++i) {
+            v.push_back(Point(coord(gen), coord(gen)));
+        }
+        Polygon polygon(v);
+        BoundingCircle circle = polygon.boundingCircle();
+        BoundingCircle expected = slow_enclosing_circle(v);
+        assert(std::fabs(circle.radius - expected.radius) < 1e-9 * (1 + expected.radius));
+        assert((circle.center - expected.center).len() < 1e-6);
+        for (const Point& p : v) {
+            assert(circle.containsPoint(p));
+        }
+        polygon.apply(AffineTransform::rotation(Point(1, 1), 50).scale(Point(0, 2), 1.5));
+        polygon.insertVertex(1, (polygon.getVertices()[0] + polygon.getVertices()[1]) / 2);
+        polygon.moveVertex(0, polygon.getVertices()[0] * 1.1);
+        std::vector<Point> w(polygon.getVertices().begin(), polygon.getVertices().end());
+        assert(std::fabs(polygon.boundingCircle().radius - slow_enclosing_circle(w).radius) < 1e-9 * (1 + expected.radius));
+    }
+    Ellipse ellipse(Point(-1, 2), Point(3, -1), 9);
+    assert((ellipse.boundingCircle().center - Point(1, 0.5)).len() < 1e-12);
+    assert(std::fabs(ellipse.boundingCircle().radius - 4.5) < 1e-12);
+}
+
+// the centres satisfy their definitions on random triangles of both orientations, and every
+// batch kernel over a mesh split across threads matches the per-triangle methods
+void triangle_centres() {
+    std::mt19937 gen(47);
+    std::uniform_real_distribution<double> coord(-50, 50);
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i < 40000; ++i) {
+        Point a(coord(gen), coord(gen));
+        Point b(coord(gen), coord(gen));
+        Point c(coord(gen), coord(gen));
+        if (std::fabs((b - a).crossProduct(c - a)) < 1) continue;
+        triangles.push_back(Triangle(a, b, c));
+    }
+    for (size_t i = 0; i < 2000; ++i) {
+        const Triangle& t = triangles[i];
+        const auto& v = t.getVertices();
+        double scale = std::max({(v[1] - v[0]).len(), (v[2] - v[1]).len(), (v[0] - v[2]).len()});
+        double tolerance = 1e-9 * scale;
+        auto close = [&](double lhs, double rhs) { return std::fabs(lhs - rhs) < tolerance; };
+        Circle outer = t.circumscribedCircle();
+        for (const Point& p : v) {
+            assert(close((p - outer.center()).len(), outer.radius()));
+        }
+        Circle inner = t.inscribedCircle();
+        assert(t.containsPoint(inner.center()));
+        for (size_t k = 0; k < 3; ++k) {
+            assert(close(Line(v[k], v[(k + 1) % 3]).dist(inner.center()), inner.radius()));
+        }
+        Point h = t.orthocenter();
+        for (size_t k = 0; k < 3; ++k) {
+            Point side = v[(k + 2) % 3] - v[(k + 1) % 3];
+            assert(std::fabs((h - v[k]).dotProduct(side)) < 1e-9 * scale * scale * (1 + (h - v[k]).len()));
+        }
+        Circle nine = t.ninePointsCircle();
+        assert(close(nine.radius(), outer.radius() / 2));
+        for (size_t k = 0; k < 3; ++k) {
+            assert(close(((v[k] + v[(k + 1) % 3]) / 2 - nine.center()).len(), nine.radius()));
+        }
+        Line euler = t.EulerLine();
+        assert(euler.dist(outer.center()) < 1e-9 * (scale + outer.radius()));
+        assert(euler.dist(nine.center()) < 1e-9 * (scale + outer.radius()));
+    }
+
+    TriangleArrays arrays(triangles);
+    CircleArrays outer = circumscribedCircles(arrays);
+    CircleArrays inner = inscribedCircles(arrays);
+    CircleArrays nine = ninePointsCircles(arrays);
+    PointArrays heights = orthocenters(arrays);
+    LineArrays euler = EulerLines(arrays);
+    std::vector<double> ratios = radiusRatios(arrays);
+    assert(arrays.size() == triangles.size() && ratios.size() == triangles.size());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        const Triangle& t = triangles[i];
+        Circle o = t.circumscribedCircle();
+        Circle r = t.inscribedCircle();
+        Circle n = t.ninePointsCircle();
+        Point h = t.orthocenter();
+        double tolerance = 1e-9 * (1 + o.radius());
+        assert((Point(outer.x[i], outer.y[i]) - o.center()).len() < tolerance && std::fabs(outer.radius[i] - o.radius()) < tolerance);
+        assert((Point(inner.x[i], inner.y[i]) - r.center()).len() < tolerance && std::fabs(inner.radius[i] - r.radius()) < tolerance);
+        assert((Point(nine.x[i], nine.y[i]) - n.center()).len() < tolerance && std::fabs(nine.radius[i] - n.radius()) < tolerance);
+        assert((Point(heights.x[i], heights.y[i]) - h).len() < tolerance);
+        Line line;
+        line.a = euler.a[i];
+        line.b = euler.b[i];
+        line.c = euler.c[i];
+        assert(line == t.EulerLine());
+        assert(std::fabs(ratios[i] - o.radius() / r.radius()) < 1e-9 * ratios[i]);
+    }
+
+    std::vector<Point> vertices = {Point(0, 0), Point(2, 0), Point(0, 2), Point(2, 2)};
+    std::vector<std::array<size_t, 3>> mesh = {{0, 1, 2}, {1, 3, 2}};
+    TriangleArrays indexed(vertices, mesh);
+    assert(indexed.size() == 2 && std::fabs(radiusRatios(indexed)[1] - (1 + sqrt(2))) < 1e-12);
+    mesh.push_back({0, 1, 4});
+    bool thrown = false;
+    try {
+        TriangleArrays broken(vertices, mesh);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    boundary_tolerance();
+    convex_fan();
+    tolerant_cyclic_shift();
+    similarity();
+    vertex_edits();
+    fixed_vertices();
+    affine_transforms();
+    winding_number();
+    cached_quantities();
+    convex_hull();
+    convex_intersection();
+    coordinate_types();
+    ellipse_containment();
+    triangulation();
+    orientation_predicates();
+    incircle_predicate();
+    simplification();
+    enclosing_circles();
+    triangle_centres();
+}
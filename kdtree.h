@@ -0,0 +1,269 @@
+#pragma once
+
+#include <queue>
+#include "geometry.h"
+
+// Static 2-d tree over points. The points are permuted so that every subtree is a
+// contiguous range with its splitting point in the middle; the split alternates
+// between x and y with depth, so no node stores anything. Ranges of at most
+// leaf_size points are left unsorted and scanned. Results are indices into the
+// span the tree was built from.
+class KdTree {
+public:
+    KdTree() = default;
+
+    explicit KdTree(std::span<const Point> points);
+
+    void build(std::span<const Point> points);
+
+    size_t size() const;
+
+    // none for an empty tree
+    size_t nearest(const Point& point) const;
+
+    // the k nearest points, nearest first
+    std::vector<size_t> nearest(const Point& point, size_t k) const;
+
+    // the points at distance at most radius, in no particular order
+    std::vector<size_t> within(const Point& point, double radius) const;
+
+    // a point equal to point in the sense of Point::operator==, or none
+    size_t find(const Point& point) const;
+
+    std::vector<size_t> nearest(std::span<const Point> queries) const;
+
+    std::vector<std::vector<size_t>> nearest(std::span<const Point> queries, size_t k) const;
+
+    std::vector<std::vector<size_t>> within(std::span<const Point> queries, double radius) const;
+
+    std::vector<size_t> find(std::span<const Point> queries) const;
+
+    static const constexpr size_t none = static_cast<size_t>(-1);
+
+private:
+    struct Range {
+        size_t first;
+        size_t last;
+        size_t depth;
+    };
+
+    static const size_t leaf_size = 8;
+    static const size_t max_depth = 64;
+
+    std::vector<Point> points;
+    std::vector<size_t> index;
+
+    static double coordinate(const Point& point, size_t depth);
+
+    static double squared_distance(const Point& lhs, const Point& rhs);
+
+    static void split(std::vector<std::pair<Point, size_t>>& items, Range range, std::vector<Range>& children);
+
+    // calls visit(i) for the points of every subtree that reach(gap) accepts, where gap is the
+    // squared distance from point to the splitting line the subtree lies behind
+    template <typename Visit, typename Reach>
+    void search(const Point& point, Visit visit, Reach reach) const;
+
+    template <typename Result, typename Query>
+    static std::vector<Result> batch(std::span<const Point> queries, Query query);
+};
+
+KdTree::KdTree(std::span<const Point> points) {
+    build(points);
+}
+
+double KdTree::coordinate(const Point& point, size_t depth) {
+    return depth % 2 == 0 ? point.x : point.y;
+}
+
+double KdTree::squared_distance(const Point& lhs, const Point& rhs) {
+    double dx = lhs.x - rhs.x;
+    double dy = lhs.y - rhs.y;
+    return dx * dx + dy * dy;
+}
+
+void KdTree::split(std::vector<std::pair<Point, size_t>>& items, Range range, std::vector<Range>& children) {
+    if (range.last - range.first <= leaf_size) return;
+    size_t middle = range.first + (range.last - range.first) / 2;
+    std::nth_element(items.begin() + range.first, items.begin() + middle, items.begin() + range.last,
+                     [depth = range.depth](const auto& lhs, const auto& rhs) {
+        return coordinate(lhs.first, depth) < coordinate(rhs.first, depth);
+    });
+    children.push_back({range.first, middle, range.depth + 1});
+    children.push_back({middle + 1, range.last, range.depth + 1});
+}
+
+// the top levels are split on one core until there is a subtree for every core,
+// then the subtrees are finished in parallel
+void KdTree::build(std::span<const Point> input) {
+    std::vector<std::pair<Point, size_t>> items(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        items[i] = {input[i], i};
+    }
+    size_t subtrees = 4 * std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<Range> level = {{0, items.size(), 0}};
+    std::vector<Range> next;
+    while (level.size() < subtrees && level[0].last - level[0].first > leaf_size) {
+        next.clear();
+        for (const Range& range : level) {
+            split(items, range, next);
+        }
+        if (next.empty()) break;
+        std::swap(level, next);
+    }
+    Geometry::parallel_for(level.size(), [&](size_t first, size_t last) {
+        std::vector<Range> stack(level.begin() + first, level.begin() + last);
+        while (!stack.empty()) {
+            Range range = stack.back();
+            stack.pop_back();
+            split(items, range, stack);
+        }
+    }, 1);
+    points.resize(items.size());
+    index.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        points[i] = items[i].first;
+        index[i] = items[i].second;
+    }
+}
+
+size_t KdTree::size() const {
+    return points.size();
+}
+
+template <typename Visit, typename Reach>
+void KdTree::search(const Point& point, Visit visit, Reach reach) const {
+    if (points.empty()) return;
+    struct Pending {
+        Range range;
+        double gap;
+    };
+    Pending stack[2 * max_depth];
+    size_t top = 0;
+    stack[top++] = {{0, points.size(), 0}, 0};
+    while (top) {
+        Pending pending = stack[--top];
+        if (!reach(pending.gap)) continue;
+        Range range = pending.range;
+        while (range.last - range.first > leaf_size) {
+            size_t middle = range.first + (range.last - range.first) / 2;
+            visit(middle);
+            double offset = coordinate(point, range.depth) - coordinate(points[middle], range.depth);
+            Range low = {range.first, middle, range.depth + 1};
+            Range high = {middle + 1, range.last, range.depth + 1};
+            // the far side is only entered after the near side has had its chance to shrink reach
+            stack[top++] = {offset < 0 ? high : low, offset * offset};
+            range = offset < 0 ? low : high;
+        }
+        for (size_t i = range.first; i < range.last; ++i) {
+            visit(i);
+        }
+    }
+}
+
+size_t KdTree::nearest(const Point& point) const {
+    size_t best = none;
+    double best_distance = std::numeric_limits<double>::infinity();
+    search(point, [&](size_t i) {
+        double distance = squared_distance(point, points[i]);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }, [&](double gap) { return gap < best_distance; });
+    return best == none ? none : index[best];
+}
+
+std::vector<size_t> KdTree::nearest(const Point& point, size_t k) const {
+    using Entry = std::pair<double, size_t>;
+    std::priority_queue<Entry> heap;
+    if (k == 0) return {};
+    search(point, [&](size_t i) {
+        double distance = squared_distance(point, points[i]);
+        if (heap.size() < k) {
+            heap.push({distance, i});
+        } else if (distance < heap.top().first) {
+            heap.pop();
+            heap.push({distance, i});
+        }
+    }, [&](double gap) { return heap.size() < k || gap < heap.top().first; });
+    std::vector<size_t> result(heap.size());
+    for (size_t j = result.size(); j > 0; --j) {
+        result[j - 1] = index[heap.top().second];
+        heap.pop();
+    }
+    return result;
+}
+
+std::vector<size_t> KdTree::within(const Point& point, double radius) const {
+    std::vector<size_t> result;
+    if (!(radius >= 0)) return result;
+    double squared = radius * radius;
+    search(point, [&](size_t i) {
+        if (squared_distance(point, points[i]) <= squared) result.push_back(index[i]);
+    }, [&](double gap) { return gap <= squared; });
+    return result;
+}
+
+// Point::operator== compares each coordinate within eps, so the candidates lie in a box
+size_t KdTree::find(const Point& point) const {
+    size_t result = none;
+    search(point, [&](size_t i) {
+        if (result == none && points[i] == point) result = index[i];
+    }, [&](double gap) { return result == none && gap < Point::eps * Point::eps; });
+    return result;
+}
+
+// queries run in Morton order of a 2^16 grid over their box, so that consecutive
+// queries walk the same paths of the tree and find them in cache
+template <typename Result, typename Query>
+std::vector<Result> KdTree::batch(std::span<const Point> queries, Query query) {
+    std::vector<Result> result(queries.size());
+    BoundingBox box;
+    for (const Point& q : queries) {
+        box.extend(q);
+    }
+    auto spread = [](uint64_t v) {
+        v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+        v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+        v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        return (v | (v << 1)) & 0x5555555555555555ull;
+    };
+    auto cell = [](double value, double lower, double upper) {
+        if (!(upper > lower)) return uint64_t(0);
+        return static_cast<uint64_t>(std::min(65535.0, std::max(0.0, (value - lower) / (upper - lower) * 65536)));
+    };
+    std::vector<std::pair<uint64_t, size_t>> order(queries.size());
+    Geometry::parallel_for(queries.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            uint64_t x = cell(queries[i].x, box.lower.x, box.upper.x);
+            uint64_t y = cell(queries[i].y, box.lower.y, box.upper.y);
+            order[i] = {spread(x) | (spread(y) << 1), i};
+        }
+    });
+    std::sort(order.begin(), order.end());
+    Geometry::parallel_for(queries.size(), [&](size_t first, size_t last) {
+        for (size_t j = first; j < last; ++j) {
+            size_t i = order[j].second;
+            result[i] = query(queries[i]);
+        }
+    });
+    return result;
+}
+
+std::vector<size_t> KdTree::nearest(std::span<const Point> queries) const {
+    return batch<size_t>(queries, [this](const Point& q) { return nearest(q); });
+}
+
+std::vector<std::vector<size_t>> KdTree::nearest(std::span<const Point> queries, size_t k) const {
+    return batch<std::vector<size_t>>(queries, [this, k](const Point& q) { return nearest(q, k); });
+}
+
+std::vector<std::vector<size_t>> KdTree::within(std::span<const Point> queries, double radius) const {
+    return batch<std::vector<size_t>>(queries, [this, radius](const Point& q) { return within(q, radius); });
+}
+
+std::vector<size_t> KdTree::find(std::span<const Point> queries) const {
+    return batch<size_t>(queries, [this](const Point& q) { return find(q); });
+}
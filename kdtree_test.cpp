@@ -0,0 +1,138 @@
+// g++ -std=c++20 -O0 -pthread kdtree_test.cpp -o kdtree_test && ./kdtree_test
+// Exits with a failed assertion if a k-d tree query disagrees with a scan over all points.
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <thread>
+#include <vector>
+#include "kdtree.h"
+
+// Reports eight hardware threads whatever the machine has, so the build finishes its subtrees
+// and the batches run on several threads. Geometry::parallel_for asks std::thread, and the
+// definition here takes precedence over the library's.
+unsigned int std::thread::hardware_concurrency() noexcept {
+    return 8;
+}
+
+// random points, a grid with many equal distances and some repeated points
+std::vector<Point> cloud() {
+    std::mt19937 gen(45);
+    std::uniform_real_distribution<double> coord(-100, 100);
+    std::vector<Point> points;
+    for (size_t i = 0; i < 15000; ++i) {
+        points.push_back(Point(coord(gen), coord(gen)));
+    }
+    for (int x = -20; x <= 20; ++x) {
+        for (int y = -20; y <= 20; ++y) {
+            points.push_back(Point(x * 2.5, y * 2.5));
+        }
+    }
+    for (size_t i = 0; i < 500; ++i) {
+        points.push_back(points[i * 7]);
+    }
+    return points;
+}
+
+std::vector<Point> queries() {
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<double> coord(-120, 120);
+    std::vector<Point> result;
+    for (size_t i = 0; i < 300; ++i) {
+        result.push_back(Point(coord(gen), coord(gen)));
+    }
+    for (int x = -3; x <= 3; ++x) {
+        result.push_back(Point(x * 2.5 + 1.25, 1.25));
+        result.push_back(Point(x * 2.5, -5));
+    }
+    return result;
+}
+
+// distances from q to the points at the given indices, in increasing order
+std::vector<double> distances(const std::vector<Point>& points, const Point& q, std::vector<size_t> indices) {
+    std::vector<double> result;
+    for (size_t i : indices) {
+        result.push_back((points[i] - q).len());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// nearest and k-nearest find points as close as the closest ones of a scan, nearest first
+void nearest() {
+    std::vector<Point> points = cloud();
+    KdTree tree(points);
+    assert(tree.size() == points.size());
+    std::vector<Point> qs = queries();
+    std::vector<size_t> batch = tree.nearest(qs);
+    std::vector<std::vector<size_t>> batch_k = tree.nearest(qs, 12);
+    for (size_t j = 0; j < qs.size(); ++j) {
+        const Point& q = qs[j];
+        std::vector<size_t> all(points.size());
+        for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+        std::vector<double> scan = distances(points, q, all);
+        size_t best = tree.nearest(q);
+        assert((points[best] - q).len() == scan[0]);
+        assert(batch[j] == best);
+        std::vector<size_t> k = tree.nearest(q, 12);
+        assert(k.size() == 12 && batch_k[j] == k);
+        for (size_t i = 0; i < k.size(); ++i) {
+            assert((points[k[i]] - q).len() == scan[i]);
+        }
+        std::sort(k.begin(), k.end());
+        assert(std::unique(k.begin(), k.end()) == k.end());
+    }
+    std::vector<Point> few = {Point(0, 0), Point(1, 0), Point(3, 0)};
+    KdTree small(few);
+    assert((small.nearest(Point(5, 0), 10) == std::vector<size_t>{2, 1, 0}));
+    assert(small.nearest(Point(5, 0), 0).empty());
+}
+
+// within returns exactly the points in the closed disc, and find a point equal to the query
+void within_and_find() {
+    std::vector<Point> points = cloud();
+    KdTree tree(points);
+    std::vector<Point> qs = queries();
+    for (double radius : {0.0, 2.5, 11.0}) {
+        std::vector<std::vector<size_t>> batch = tree.within(qs, radius);
+        for (size_t j = 0; j < qs.size(); ++j) {
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < points.size(); ++i) {
+                double dx = points[i].x - qs[j].x;
+                double dy = points[i].y - qs[j].y;
+                if (dx * dx + dy * dy <= radius * radius) expected.push_back(i);
+            }
+            std::vector<size_t> found = tree.within(qs[j], radius);
+            std::sort(found.begin(), found.end());
+            assert(found == expected);
+            std::sort(batch[j].begin(), batch[j].end());
+            assert(batch[j] == expected);
+        }
+    }
+    assert(tree.within(Point(0, 0), -1).empty());
+
+    std::vector<Point> probes = {points[3], points[15000 + 41 * 20 + 20] + Point(Point::eps / 2, 0), Point(0.1, 0.1), points[7 * 13]};
+    std::vector<size_t> batch = tree.find(probes);
+    for (size_t j = 0; j < probes.size(); ++j) {
+        size_t found = tree.find(probes[j]);
+        assert(batch[j] == found);
+        bool exists = std::any_of(points.begin(), points.end(), [&](const Point& p) { return p == probes[j]; });
+        assert(exists == (found != KdTree::none));
+        if (exists) assert(points[found] == probes[j]);
+    }
+}
+
+// an empty tree answers every query with nothing
+void empty_tree() {
+    KdTree tree;
+    std::vector<Point> qs = queries();
+    assert(tree.size() == 0 && tree.nearest(Point(1, 1)) == KdTree::none);
+    assert(tree.nearest(qs) == std::vector<size_t>(qs.size(), KdTree::none));
+    assert(tree.nearest(Point(1, 1), 3).empty() && tree.within(Point(1, 1), 10).empty());
+    assert(tree.find(qs) == std::vector<size_t>(qs.size(), KdTree::none));
+}
+
+int main() {
+    nearest();
+    within_and_find();
+    empty_tree();
+}
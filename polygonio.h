@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "geometry.h"
+
+// Binary polygon file, native byte order, every field 8-byte aligned:
+//   header: magic "GPOLYBIN", uint64 version, uint64 polygon count
+//   record: uint64 vertex count, then x0 y0 x1 y1 ... as doubles
+namespace PolygonFormat {
+    static const constexpr char magic[8] = {'G', 'P', 'O', 'L', 'Y', 'B', 'I', 'N'};
+    static const constexpr uint64_t version = 1;
+    static const constexpr size_t header_size = 24;
+}
+
+static_assert(sizeof(Point) == 2 * sizeof(double) && std::is_standard_layout_v<Point>,
+              "polygon files are read in place as Point arrays");
+
+// Read-only polygon over vertices it does not own. Derived quantities are computed
+// on every call; materialize() makes an owning Polygon for mutation.
+class PolygonView {
+public:
+    PolygonView() = default;
+
+    explicit PolygonView(std::span<const Point> vertices): vertices(vertices) {}
+
+    size_t verticesCount() const;
+
+    std::span<const Point> getVertices() const;
+
+    double area() const;
+
+    double perimeter() const;
+
+    bool containsPoint(const Point& point) const;
+
+    bool isConvex() const;
+
+    Polygon materialize() const;
+
+private:
+    std::span<const Point> vertices;
+};
+
+size_t PolygonView::verticesCount() const {
+    return vertices.size();
+}
+
+std::span<const Point> PolygonView::getVertices() const {
+    return vertices;
+}
+
+double PolygonView::area() const {
+    return Geometry::polygon_area(vertices);
+}
+
+double PolygonView::perimeter() const {
+    return Geometry::polygon_perimeter(vertices);
+}
+
+bool PolygonView::containsPoint(const Point& point) const {
+    return Geometry::polygon_contains(vertices, point);
+}
+
+bool PolygonView::isConvex() const {
+    return Geometry::polygon_convex(vertices);
+}
+
+Polygon PolygonView::materialize() const {
+    return Polygon(vertices);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Maps the whole file and walks it front to back. Pages are only touched when the
+// iterator reaches them, so files larger than memory stream through the page cache.
+class PolygonReader {
+public:
+    class iterator {
+    public:
+        using value_type = PolygonView;
+        using reference = PolygonView;
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = ptrdiff_t;
+
+        PolygonView operator*() const;
+
+        iterator& operator++();
+
+        iterator operator++(int);
+
+        bool operator==(const iterator& other) const = default;
+
+        friend class PolygonReader;
+    private:
+        const char* position = nullptr;
+        const char* end = nullptr;
+        iterator(const char* position, const char* end): position(position), end(end) {}
+        size_t record_size() const;
+    };
+
+    explicit PolygonReader(const std::string& path);
+
+    PolygonReader(const PolygonReader& other) = delete;
+
+    PolygonReader& operator=(const PolygonReader& other) = delete;
+
+    ~PolygonReader();
+
+    size_t size() const;
+
+    iterator begin() const;
+
+    iterator end() const;
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t count = 0;
+};
+
+size_t PolygonReader::iterator::record_size() const {
+    uint64_t vertices;
+    if (static_cast<size_t>(end - position) < sizeof(vertices)) throw std::runtime_error("PolygonReader: truncated record");
+    std::memcpy(&vertices, position, sizeof(vertices));
+    if (vertices > (static_cast<size_t>(end - position) - sizeof(vertices)) / sizeof(Point)) {
+        throw std::runtime_error("PolygonReader: truncated record");
+    }
+    return sizeof(vertices) + vertices * sizeof(Point);
+}
+
+PolygonView PolygonReader::iterator::operator*() const {
+    size_t size = (record_size() - sizeof(uint64_t)) / sizeof(Point);
+    return PolygonView({reinterpret_cast<const Point*>(position + sizeof(uint64_t)), size});
+}
+
+PolygonReader::iterator& PolygonReader::iterator::operator++() {
+    position += record_size();
+    return *this;
+}
+
+PolygonReader::iterator PolygonReader::iterator::operator++(int) {
+    iterator it = *this;
+    ++*this;
+    return it;
+}
+
+PolygonReader::PolygonReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+    struct stat info;
+    if (::fstat(fd, &info) < 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), path);
+    }
+    length = info.st_size;
+    if (length < PolygonFormat::header_size) {
+        ::close(fd);
+        throw std::runtime_error("PolygonReader: " + path + " is not a polygon file");
+    }
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::system_error(error, std::generic_category(), path);
+    data = static_cast<const char*>(mapped);
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+    uint64_t version;
+    std::memcpy(&version, data + sizeof(PolygonFormat::magic), sizeof(version));
+    std::memcpy(&count, data + sizeof(PolygonFormat::magic) + sizeof(version), sizeof(count));
+    if (std::memcmp(data, PolygonFormat::magic, sizeof(PolygonFormat::magic)) != 0 || version != PolygonFormat::version) {
+        ::munmap(mapped, length);
+        throw std::runtime_error("PolygonReader: " + path + " is not a polygon file");
+    }
+}
+
+PolygonReader::~PolygonReader() {
+    ::munmap(const_cast<char*>(data), length);
+}
+
+size_t PolygonReader::size() const {
+    return count;
+}
+
+PolygonReader::iterator PolygonReader::begin() const {
+    return {data + PolygonFormat::header_size, data + length};
+}
+
+PolygonReader::iterator PolygonReader::end() const {
+    return {data + length, data + length};
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+class PolygonWriter {
+public:
+    explicit PolygonWriter(const std::string& path);
+
+    PolygonWriter(const PolygonWriter& other) = delete;
+
+    PolygonWriter& operator=(const PolygonWriter& other) = delete;
+
+    ~PolygonWriter();
+
+    void write(std::span<const Point> vertices);
+
+    void write(const Polygon& polygon);
+
+    void close();
+
+private:
+    std::ofstream out;
+    uint64_t count = 0;
+};
+
+PolygonWriter::PolygonWriter(const std::string& path): out(path, std::ios::binary | std::ios::trunc) {
+    if (!out) throw std::runtime_error("PolygonWriter: cannot open " + path);
+    out.write(PolygonFormat::magic, sizeof(PolygonFormat::magic));
+    out.write(reinterpret_cast<const char*>(&PolygonFormat::version), sizeof(PolygonFormat::version));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+}
+
+PolygonWriter::~PolygonWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void PolygonWriter::write(std::span<const Point> vertices) {
+    uint64_t size = vertices.size();
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char*>(vertices.data()), vertices.size_bytes());
+    if (!out) throw std::runtime_error("PolygonWriter: write failed");
+    ++count;
+}
+
+void PolygonWriter::write(const Polygon& polygon) {
+    write(std::span<const Point>(polygon.getVertices()));
+}
+
+// patches the polygon count into the header
+void PolygonWriter::close() {
+    if (!out.is_open()) return;
+    out.seekp(sizeof(PolygonFormat::magic) + sizeof(PolygonFormat::version));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.close();
+    if (!out) throw std::runtime_error("PolygonWriter: write failed");
+}
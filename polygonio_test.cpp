@@ -0,0 +1,87 @@
+// g++ -std=c++20 -O2 polygonio_test.cpp -o polygonio_test && ./polygonio_test
+// Exits with a failed assertion if polygons do not survive a round trip through a file.
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "polygonio.h"
+
+std::string scratch(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template <typename Function>
+bool fails(Function function) {
+    try {
+        function();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+// the views point into the mapping and see exactly what was written
+void round_trip() {
+    std::mt19937 random(36);
+    std::uniform_real_distribution<double> coordinate(-100, 100);
+    std::vector<std::vector<Point>> written;
+    std::string path = scratch("polygonio_test.bin");
+    {
+        PolygonWriter writer(path);
+        for (size_t n : {3, 4, 17, 1000, 5}) {
+            std::vector<Point> v;
+            for (size_t i = 0; i < n; ++i) {
+                v.push_back(Point(coordinate(random), coordinate(random)));
+            }
+            writer.write(std::span<const Point>(v));
+            written.push_back(v);
+        }
+        writer.write(Polygon({Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)}));
+        written.push_back({Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)});
+    }
+    PolygonReader reader(path);
+    assert(reader.size() == written.size());
+    size_t k = 0;
+    for (PolygonView view : reader) {
+        std::span<const Point> v = view.getVertices();
+        assert(std::vector<Point>(v.begin(), v.end()) == written[k]);
+        Polygon owned = view.materialize();
+        Polygon expected(written[k]);
+        assert(owned == expected);
+        assert(view.area() == expected.area() && view.perimeter() == expected.perimeter());
+        assert(view.isConvex() == expected.isConvex());
+        ++k;
+    }
+    assert(k == written.size());
+    PolygonView square = *std::next(reader.begin(), 5);
+    assert(square.containsPoint(Point(1, 1)) && !square.containsPoint(Point(3, 1)));
+    std::remove(path.c_str());
+}
+
+// a file that is not a polygon file, or whose last record is cut short, is refused
+void malformed() {
+    std::string path = scratch("polygonio_test_bad.bin");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a polygon file at all";
+    }
+    assert(fails([&] { PolygonReader reader(path); }));
+    {
+        PolygonWriter writer(path);
+        std::vector<Point> triangle = {Point(0, 0), Point(1, 0), Point(0, 1)};
+        writer.write(std::span<const Point>(triangle));
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    PolygonReader reader(path);
+    assert(fails([&] { *reader.begin(); }));
+    std::remove(path.c_str());
+    assert(fails([&] { PolygonReader missing(path); }));
+}
+
+int main() {
+    round_trip();
+    malformed();
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include "geometry.h"
+
+// Shapes stored by value in one contiguous array per concrete type. Bulk
+// operations call the concrete type's methods directly and split every array
+// across cores. Per-shape results follow the order of Kind, then insertion order.
+class ShapeCollection {
+public:
+    enum class Kind { Polygon, Ellipse, Circle, Triangle, Rectangle, Square };
+
+    struct ShapeId {
+        Kind kind;
+        size_t index;
+
+        bool operator==(const ShapeId& other) const = default;
+    };
+
+    ShapeCollection() = default;
+
+    ShapeId add(const Polygon& shape);
+
+    ShapeId add(const Ellipse& shape);
+
+    ShapeId add(const Circle& shape);
+
+    ShapeId add(const Triangle& shape);
+
+    ShapeId add(const Rectangle& shape);
+
+    ShapeId add(const Square& shape);
+
+    template <typename T>
+    const std::vector<T>& get() const;
+
+    const Shape& operator[](const ShapeId& id) const;
+
+    size_t size() const;
+
+    double totalArea() const;
+
+    double totalPerimeter() const;
+
+    std::vector<double> areas() const;
+
+    std::vector<double> perimeters() const;
+
+    void apply(const AffineTransform& transform);
+
+    std::vector<ShapeId> containing(const Point& point) const;
+
+    std::vector<std::pair<ShapeId, ShapeId>> congruentPairs() const;
+
+private:
+    std::tuple<std::vector<Polygon>, std::vector<Ellipse>, std::vector<Circle>,
+               std::vector<Triangle>, std::vector<Rectangle>, std::vector<Square>> shapes;
+
+    template <typename T>
+    std::vector<T>& storage();
+
+    template <typename Function>
+    void for_each_kind(Function function) const;
+
+    template <typename Function>
+    void for_each_kind(Function function);
+
+    template <typename T>
+    static constexpr Kind kind_of();
+
+    template <typename T, typename Result, typename Function>
+    static void fill(const std::vector<T>& array, Result* out, Function function);
+
+    template <typename Base>
+    void congruent_pairs(std::vector<std::pair<ShapeId, ShapeId>>& result) const;
+};
+
+template <typename T>
+const std::vector<T>& ShapeCollection::get() const {
+    return std::get<std::vector<T>>(shapes);
+}
+
+template <typename T>
+std::vector<T>& ShapeCollection::storage() {
+    return std::get<std::vector<T>>(shapes);
+}
+
+template <typename T>
+constexpr ShapeCollection::Kind ShapeCollection::kind_of() {
+    if constexpr (std::is_same_v<T, Polygon>) return Kind::Polygon;
+    if constexpr (std::is_same_v<T, Ellipse>) return Kind::Ellipse;
+    if constexpr (std::is_same_v<T, Circle>) return Kind::Circle;
+    if constexpr (std::is_same_v<T, Triangle>) return Kind::Triangle;
+    if constexpr (std::is_same_v<T, Rectangle>) return Kind::Rectangle;
+    return Kind::Square;
+}
+
+template <typename Function>
+void ShapeCollection::for_each_kind(Function function) const {
+    std::apply([&](const auto&... arrays) { (function(arrays), ...); }, shapes);
+}
+
+template <typename Function>
+void ShapeCollection::for_each_kind(Function function) {
+    std::apply([&](auto&... arrays) { (function(arrays), ...); }, shapes);
+}
+
+template <typename T, typename Result, typename Function>
+void ShapeCollection::fill(const std::vector<T>& array, Result* out, Function function) {
+    Geometry::parallel_for(array.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            out[i] = function(array[i]);
+        }
+    });
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Polygon& shape) {
+    storage<Polygon>().push_back(shape);
+    return {Kind::Polygon, storage<Polygon>().size() - 1};
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Ellipse& shape) {
+    storage<Ellipse>().push_back(shape);
+    return {Kind::Ellipse, storage<Ellipse>().size() - 1};
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Circle& shape) {
+    storage<Circle>().push_back(shape);
+    return {Kind::Circle, storage<Circle>().size() - 1};
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Triangle& shape) {
+    storage<Triangle>().push_back(shape);
+    return {Kind::Triangle, storage<Triangle>().size() - 1};
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Rectangle& shape) {
+    storage<Rectangle>().push_back(shape);
+    return {Kind::Rectangle, storage<Rectangle>().size() - 1};
+}
+
+ShapeCollection::ShapeId ShapeCollection::add(const Square& shape) {
+    storage<Square>().push_back(shape);
+    return {Kind::Square, storage<Square>().size() - 1};
+}
+
+const Shape& ShapeCollection::operator[](const ShapeId& id) const {
+    switch (id.kind) {
+        case Kind::Polygon: return get<Polygon>()[id.index];
+        case Kind::Ellipse: return get<Ellipse>()[id.index];
+        case Kind::Circle: return get<Circle>()[id.index];
+        case Kind::Triangle: return get<Triangle>()[id.index];
+        case Kind::Rectangle: return get<Rectangle>()[id.index];
+        default: return get<Square>()[id.index];
+    }
+}
+
+size_t ShapeCollection::size() const {
+    size_t result = 0;
+    for_each_kind([&](const auto& array) { result += array.size(); });
+    return result;
+}
+
+std::vector<double> ShapeCollection::areas() const {
+    std::vector<double> result(size());
+    double* out = result.data();
+    for_each_kind([&](const auto& array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        fill(array, out, [](const T& shape) { return shape.T::area(); });
+        out += array.size();
+    });
+    return result;
+}
+
+std::vector<double> ShapeCollection::perimeters() const {
+    std::vector<double> result(size());
+    double* out = result.data();
+    for_each_kind([&](const auto& array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        fill(array, out, [](const T& shape) { return shape.T::perimeter(); });
+        out += array.size();
+    });
+    return result;
+}
+
+double ShapeCollection::totalArea() const {
+    std::vector<double> values = areas();
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+double ShapeCollection::totalPerimeter() const {
+    std::vector<double> values = perimeters();
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+void ShapeCollection::apply(const AffineTransform& transform) {
+    for_each_kind([&](auto& array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        Geometry::parallel_for(array.size(), [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                array[i].T::apply(transform);
+            }
+        });
+    });
+}
+
+std::vector<ShapeCollection::ShapeId> ShapeCollection::containing(const Point& point) const {
+    std::vector<ShapeId> result;
+    std::mutex guard;
+    for_each_kind([&](const auto& array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        Geometry::parallel_for(array.size(), [&](size_t first, size_t last) {
+            std::vector<ShapeId> local;
+            for (size_t i = first; i < last; ++i) {
+                if (array[i].T::containsPoint(point)) local.push_back({kind_of<T>(), i});
+            }
+            std::lock_guard<std::mutex> lock(guard);
+            result.insert(result.end(), local.begin(), local.end());
+        });
+    });
+    std::sort(result.begin(), result.end(), [](const ShapeId& lhs, const ShapeId& rhs) {
+        return std::make_pair(lhs.kind, lhs.index) < std::make_pair(rhs.kind, rhs.index);
+    });
+    return result;
+}
+
+// Only shapes with the same base class can be congruent. Within a base class the
+// shapes are sorted by perimeter and only neighbours closer than eps are compared.
+// Neighbours across chunk boundaries are read by two threads, so every shape is
+// precomputed first, each by one thread.
+template <typename Base>
+void ShapeCollection::congruent_pairs(std::vector<std::pair<ShapeId, ShapeId>>& result) const {
+    std::vector<std::pair<double, ShapeId>> order;
+    std::vector<const Base*> pointers;
+    for_each_kind([&](const auto& array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        if constexpr (std::is_base_of_v<Base, T>) {
+            for (size_t i = 0; i < array.size(); ++i) {
+                order.push_back({array[i].T::perimeter(), {kind_of<T>(), i}});
+            }
+        }
+    });
+    std::sort(order.begin(), order.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    pointers.reserve(order.size());
+    for (const auto& entry : order) {
+        pointers.push_back(static_cast<const Base*>(&(*this)[entry.second]));
+    }
+    Geometry::parallel_for(pointers.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            pointers[i]->precompute();
+        }
+    }, 64);
+    std::mutex guard;
+    Geometry::parallel_for(order.size(), [&](size_t first, size_t last) {
+        std::vector<std::pair<ShapeId, ShapeId>> local;
+        for (size_t i = first; i < last; ++i) {
+            for (size_t j = i + 1; j < order.size() && order[j].first - order[i].first < Shape::eps; ++j) {
+                if (pointers[i]->isCongruentTo(*pointers[j])) local.push_back({order[i].second, order[j].second});
+            }
+        }
+        std::lock_guard<std::mutex> lock(guard);
+        result.insert(result.end(), local.begin(), local.end());
+    }, 64);
+}
+
+std::vector<std::pair<ShapeCollection::ShapeId, ShapeCollection::ShapeId>> ShapeCollection::congruentPairs() const {
+    std::vector<std::pair<ShapeId, ShapeId>> result;
+    congruent_pairs<Polygon>(result);
+    congruent_pairs<Ellipse>(result);
+    return result;
+}
@@ -0,0 +1,179 @@
+// g++ -std=c++20 -O2 -pthread shapecollection_test.cpp -o shapecollection_test && ./shapecollection_test
+// Exits with a failed assertion if a parallel ShapeCollection query disagrees with a loop over its shapes.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+#include "shapecollection.h"
+
+// Reports eight hardware threads whatever the machine has, so the bulk queries really split
+// their arrays. Geometry::parallel_for asks std::thread, and the definition here takes
+// precedence over the library's.
+unsigned int std::thread::hardware_concurrency() noexcept {
+    return 8;
+}
+
+using ShapeId = ShapeCollection::ShapeId;
+
+// a star-shaped polygon with vertices at random radii around center
+Polygon blob(std::mt19937& gen, const Point& center, size_t n) {
+    std::uniform_real_distribution<double> radius(0.5, 2);
+    std::vector<Point> v;
+    for (size_t i = 0; i < n; ++i) {
+        double angle = 2 * Shape::pi * double(i) / double(n);
+        v.push_back(center + Point(cos(angle), sin(angle)) * radius(gen));
+    }
+    return Polygon(v);
+}
+
+// every shape in the collection's own order: Kind first, then insertion
+std::vector<ShapeId> ids(const ShapeCollection& shapes) {
+    std::vector<ShapeId> result;
+    auto push = [&](ShapeCollection::Kind kind, size_t count) {
+        for (size_t i = 0; i < count; ++i) result.push_back({kind, i});
+    };
+    push(ShapeCollection::Kind::Polygon, shapes.get<Polygon>().size());
+    push(ShapeCollection::Kind::Ellipse, shapes.get<Ellipse>().size());
+    push(ShapeCollection::Kind::Circle, shapes.get<Circle>().size());
+    push(ShapeCollection::Kind::Triangle, shapes.get<Triangle>().size());
+    push(ShapeCollection::Kind::Rectangle, shapes.get<Rectangle>().size());
+    push(ShapeCollection::Kind::Square, shapes.get<Square>().size());
+    return result;
+}
+
+// more than one grain of polygons and circles, so those arrays are split across threads
+ShapeCollection crowd() {
+    std::mt19937 gen(32);
+    std::uniform_real_distribution<double> coord(-20, 20);
+    ShapeCollection shapes;
+    for (size_t i = 0; i < 2500; ++i) {
+        shapes.add(blob(gen, Point(coord(gen), coord(gen)), 3 + i % 6));
+    }
+    for (size_t i = 0; i < 2100; ++i) {
+        shapes.add(Circle(Point(coord(gen), coord(gen)), 0.5 + double(i % 7) / 4));
+    }
+    for (size_t i = 0; i < 300; ++i) {
+        Point center(coord(gen), coord(gen));
+        shapes.add(Ellipse(center - Point(1, 0.5), center + Point(1, 0.5), 3 + double(i % 3)));
+        shapes.add(Triangle(center, center + Point(2, 0), center + Point(0.5, 1.5)));
+        shapes.add(Rectangle(center, center + Point(3, 1), 2));
+        shapes.add(Square(center, center + Point(1, 2)));
+    }
+    return shapes;
+}
+
+// areas, perimeters and their totals follow the collection's order
+void bulk_measures() {
+    ShapeCollection shapes = crowd();
+    std::vector<ShapeId> order = ids(shapes);
+    assert(shapes.size() == order.size());
+    std::vector<double> areas = shapes.areas();
+    std::vector<double> perimeters = shapes.perimeters();
+    double total_area = 0;
+    double total_perimeter = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        assert(std::fabs(areas[i] - shapes[order[i]].area()) < 1e-9);
+        assert(std::fabs(perimeters[i] - shapes[order[i]].perimeter()) < 1e-9);
+        total_area += shapes[order[i]].area();
+        total_perimeter += shapes[order[i]].perimeter();
+    }
+    assert(std::fabs(shapes.totalArea() - total_area) < 1e-6 * total_area);
+    assert(std::fabs(shapes.totalPerimeter() - total_perimeter) < 1e-6 * total_perimeter);
+}
+
+// containing lists exactly the shapes whose containsPoint accepts the point, in order
+void containing() {
+    ShapeCollection shapes = crowd();
+    std::vector<ShapeId> order = ids(shapes);
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> coord(-20, 20);
+    for (size_t q = 0; q < 50; ++q) {
+        Point point(coord(gen), coord(gen));
+        std::vector<ShapeId> expected;
+        for (const ShapeId& id : order) {
+            if (shapes[id].containsPoint(point)) expected.push_back(id);
+        }
+        assert(shapes.containing(point) == expected);
+    }
+}
+
+// a bulk apply moves every shape as applying the transform to it alone would
+void bulk_apply() {
+    ShapeCollection shapes = crowd();
+    ShapeCollection moved = shapes;
+    AffineTransform transform = AffineTransform(1, 0.3, -0.2, 2, 4, -1);
+    moved.apply(transform);
+    for (const ShapeId& id : ids(shapes)) {
+        assert((moved[id].centroid() - transform(shapes[id].centroid())).len() < 1e-9);
+        assert(std::fabs(moved[id].area() - shapes[id].area() * transform.determinant()) < 1e-9);
+    }
+    for (size_t i = 0; i < shapes.get<Polygon>().size(); ++i) {
+        const auto& before = shapes.get<Polygon>()[i].getVertices();
+        const auto& after = moved.get<Polygon>()[i].getVertices();
+        for (size_t j = 0; j < before.size(); ++j) {
+            assert((after[j] - transform(before[j])).len() < 1e-9);
+        }
+    }
+}
+
+// congruentPairs finds every congruent pair within the polygon family and within the ellipse
+// family, including copies moved by a rigid motion and matches across concrete types
+void congruent_pairs() {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> coord(-20, 20);
+    std::uniform_real_distribution<double> angle(0, 360);
+    ShapeCollection shapes;
+    for (size_t i = 0; i < 300; ++i) {
+        Polygon polygon = blob(gen, Point(coord(gen), coord(gen)), 3 + i % 3);
+        shapes.add(polygon);
+        if (i % 3 == 0) {
+            polygon.rotate(Point(coord(gen), coord(gen)), angle(gen));
+            polygon.reflect(Line(Point(0, 0), Point(1, 2)));
+            shapes.add(polygon);
+        }
+        if (i % 10 == 0) {
+            Point a(coord(gen), coord(gen));
+            shapes.add(Triangle(a, a + Point(3, 0), a + Point(1, 2)));
+            shapes.add(Polygon(a + Point(0, 5), a + Point(0, 2), a + Point(2, 4)));
+        }
+    }
+    for (size_t i = 0; i < 100; ++i) {
+        Point center(coord(gen), coord(gen));
+        shapes.add(Circle(center, 1 + double(i % 5)));
+        shapes.add(Ellipse(center, center + Point(1, 1), 2 + double(i % 4)));
+        shapes.add(Square(center, center + Point(double(i % 3), 1)));
+    }
+    std::vector<ShapeId> order = ids(shapes);
+    auto family = [](const ShapeId& id) {
+        return id.kind == ShapeCollection::Kind::Ellipse || id.kind == ShapeCollection::Kind::Circle;
+    };
+    auto key = [](const ShapeId& id) { return std::make_pair(int(id.kind), id.index); };
+    auto normalize = [&](std::vector<std::pair<ShapeId, ShapeId>> pairs) {
+        std::vector<std::pair<std::pair<int, size_t>, std::pair<int, size_t>>> result;
+        for (auto [first, second] : pairs) {
+            if (key(second) < key(first)) std::swap(first, second);
+            result.push_back({key(first), key(second)});
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    std::vector<std::pair<ShapeId, ShapeId>> expected;
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (size_t j = i + 1; j < order.size(); ++j) {
+            if (family(order[i]) == family(order[j]) && shapes[order[i]].isCongruentTo(shapes[order[j]])) {
+                expected.push_back({order[i], order[j]});
+            }
+        }
+    }
+    assert(expected.size() > 100);
+    assert(normalize(shapes.congruentPairs()) == normalize(expected));
+}
+
+int main() {
+    bulk_measures();
+    containing();
+    bulk_apply();
+    congruent_pairs();
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <queue>
+#include "geometry.h"
+
+// Bounding volume hierarchy over shapes. The index does not own the shapes;
+// after a shape is rotated, reflected or scaled call update() for it.
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+
+    explicit SpatialIndex(const std::vector<Shape*>& shapes);
+
+    void build(const std::vector<Shape*>& shapes);
+
+    void rebuild();
+
+    void update(const Shape* shape);
+
+    size_t size() const;
+
+    std::vector<Shape*> containing(const Point& point) const;
+
+    std::vector<Shape*> intersecting(const BoundingBox& range) const;
+
+    Shape* nearest(const Point& point) const;
+
+    static double distance(const Shape& shape, const Point& point);
+
+private:
+    struct Node {
+        BoundingBox box;
+        size_t parent;
+        size_t right;
+        size_t first;
+        size_t count;
+    };
+
+    static const size_t leaf_size = 4;
+    static const constexpr size_t none = static_cast<size_t>(-1);
+
+    std::vector<Node> nodes;
+    std::vector<Shape*> items;
+    std::vector<BoundingBox> boxes;
+    std::vector<size_t> leaf_of;
+    std::unordered_map<const Shape*, size_t> position;
+
+    size_t build_node(size_t first, size_t last, size_t parent);
+
+    void refit(size_t node);
+
+    static double distance(const Ellipse& ellipse, const Point& point);
+
+    static double distance(const Polygon& polygon, const Point& point);
+};
+
+SpatialIndex::SpatialIndex(const std::vector<Shape*>& shapes) {
+    build(shapes);
+}
+
+void SpatialIndex::build(const std::vector<Shape*>& shapes) {
+    items = shapes;
+    rebuild();
+}
+
+void SpatialIndex::rebuild() {
+    nodes.clear();
+    boxes.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        boxes[i] = items[i]->boundingBox();
+    }
+    if (!items.empty()) {
+        nodes.reserve(2 * (items.size() / leaf_size + 1));
+        build_node(0, items.size(), none);
+    }
+    position.clear();
+    leaf_of.assign(items.size(), none);
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        for (size_t i = nodes[node].first; i < nodes[node].first + nodes[node].count; ++i) {
+            leaf_of[i] = node;
+        }
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+        position[items[i]] = i;
+    }
+}
+
+size_t SpatialIndex::build_node(size_t first, size_t last, size_t parent) {
+    size_t node = nodes.size();
+    nodes.push_back({BoundingBox(), parent, none, first, 0});
+    BoundingBox centers;
+    for (size_t i = first; i < last; ++i) {
+        nodes[node].box.extend(boxes[i]);
+        centers.extend(boxes[i].center());
+    }
+    if (last - first <= leaf_size) {
+        nodes[node].count = last - first;
+        return node;
+    }
+    bool by_x = centers.upper.x - centers.lower.x >= centers.upper.y - centers.lower.y;
+    std::vector<size_t> order(last - first);
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = first + i;
+    }
+    size_t middle = order.size() / 2;
+    std::nth_element(order.begin(), order.begin() + middle, order.end(), [&](size_t lhs, size_t rhs) {
+        Point l = boxes[lhs].center();
+        Point r = boxes[rhs].center();
+        return by_x ? l.x < r.x : l.y < r.y;
+    });
+    std::vector<Shape*> sorted_items(order.size());
+    std::vector<BoundingBox> sorted_boxes(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sorted_items[i] = items[order[i]];
+        sorted_boxes[i] = boxes[order[i]];
+    }
+    std::copy(sorted_items.begin(), sorted_items.end(), items.begin() + first);
+    std::copy(sorted_boxes.begin(), sorted_boxes.end(), boxes.begin() + first);
+    build_node(first, first + middle, node);
+    size_t right = build_node(first + middle, last, node);
+    nodes[node].right = right;
+    return node;
+}
+
+void SpatialIndex::refit(size_t node) {
+    for (; node != none; node = nodes[node].parent) {
+        BoundingBox box;
+        if (nodes[node].count) {
+            for (size_t i = nodes[node].first; i < nodes[node].first + nodes[node].count; ++i) {
+                box.extend(boxes[i]);
+            }
+        } else {
+            box.extend(nodes[node + 1].box);
+            box.extend(nodes[nodes[node].right].box);
+        }
+        nodes[node].box = box;
+    }
+}
+
+void SpatialIndex::update(const Shape* shape) {
+    auto it = position.find(shape);
+    if (it == position.end()) return;
+    boxes[it->second] = shape->boundingBox();
+    refit(leaf_of[it->second]);
+}
+
+size_t SpatialIndex::size() const {
+    return items.size();
+}
+
+std::vector<Shape*> SpatialIndex::containing(const Point& point) const {
+    std::vector<Shape*> result;
+    if (nodes.empty()) return result;
+    std::vector<size_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        size_t index = stack.back();
+        stack.pop_back();
+        if (!node.box.containsPoint(point)) continue;
+        if (node.count) {
+            for (size_t i = node.first; i < node.first + node.count; ++i) {
+                if (boxes[i].containsPoint(point) && items[i]->containsPoint(point)) {
+                    result.push_back(items[i]);
+                }
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(index + 1);
+        }
+    }
+    return result;
+}
+
+std::vector<Shape*> SpatialIndex::intersecting(const BoundingBox& range) const {
+    std::vector<Shape*> result;
+    if (nodes.empty()) return result;
+    std::vector<size_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        size_t index = stack.back();
+        stack.pop_back();
+        if (!node.box.intersects(range)) continue;
+        if (node.count) {
+            for (size_t i = node.first; i < node.first + node.count; ++i) {
+                if (boxes[i].intersects(range)) {
+                    result.push_back(items[i]);
+                }
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(index + 1);
+        }
+    }
+    return result;
+}
+
+Shape* SpatialIndex::nearest(const Point& point) const {
+    if (nodes.empty()) return nullptr;
+    using Entry = std::pair<double, size_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    queue.emplace(nodes[0].box.distance(point), 0);
+    Shape* best = nullptr;
+    double best_dist = std::numeric_limits<double>::infinity();
+    while (!queue.empty() && queue.top().first < best_dist) {
+        size_t index = queue.top().second;
+        queue.pop();
+        const Node& node = nodes[index];
+        if (node.count) {
+            for (size_t i = node.first; i < node.first + node.count; ++i) {
+                if (boxes[i].distance(point) >= best_dist) continue;
+                double dist = distance(*items[i], point);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = items[i];
+                }
+            }
+        } else {
+            queue.emplace(nodes[index + 1].box.distance(point), index + 1);
+            queue.emplace(nodes[node.right].box.distance(point), node.right);
+        }
+    }
+    return best;
+}
+
+double SpatialIndex::distance(const Shape& shape, const Point& point) {
+    if (shape.containsPoint(point)) return 0;
+    if (const Polygon* polygon = dynamic_cast<const Polygon*>(&shape)) return distance(*polygon, point);
+    if (const Ellipse* ellipse = dynamic_cast<const Ellipse*>(&shape)) return distance(*ellipse, point);
+    return shape.boundingBox().distance(point);
+}
+
+double SpatialIndex::distance(const Polygon& polygon, const Point& point) {
+    const std::pmr::vector<Point>& v = polygon.getVertices();
+    double result = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < v.size(); ++i) {
+        const Point& a = v[i];
+        const Point& b = v[i + 1 == v.size() ? 0 : i + 1];
+        Point ab = b - a;
+        double t = ab.dotProduct(ab) < Shape::eps ? 0 : (point - a).dotProduct(ab) / ab.dotProduct(ab);
+        t = std::clamp(t, 0.0, 1.0);
+        result = std::min(result, (a + ab * t - point).len());
+    }
+    return result;
+}
+
+// Distance to the boundary of an ellipse for a point outside it: bisection on the
+// Lagrange multiplier of the nearest boundary point in the canonical frame.
+double SpatialIndex::distance(const Ellipse& ellipse, const Point& point) {
+    std::pair<Point, Point> foci = ellipse.focuses();
+    Point center = ellipse.center();
+    auto [a, b] = ellipse.semiAxes();
+    double focus_dist = (foci.second - foci.first).len() / 2;
+    if (focus_dist < Shape::eps) return (point - center).len() - a;
+    Point u = (foci.second - foci.first) / (2 * focus_dist);
+    Point d = point - center;
+    double y0 = fabs(d.dotProduct(u));
+    double y1 = fabs(u.crossProduct(d));
+    if (y1 < Shape::eps) {
+        if (a * y0 < a * a - b * b) {
+            double x0 = a * a * y0 / (a * a - b * b);
+            double x1 = b * sqrt(1 - x0 * x0 / (a * a));
+            return sqrt((x0 - y0) * (x0 - y0) + x1 * x1);
+        }
+        return fabs(y0 - a);
+    }
+    if (y0 < Shape::eps) return fabs(y1 - b);
+    double r0 = a * a / (b * b);
+    double z0 = y0 / a;
+    double z1 = y1 / b;
+    double n0 = r0 * z0;
+    double lo = z1 - 1;
+    double hi = sqrt(n0 * n0 + z1 * z1) - 1;
+    for (int iter = 0; iter < 128 && lo < hi; ++iter) {
+        double mid = (lo + hi) / 2;
+        if (mid == lo || mid == hi) break;
+        double g = (n0 / (mid + r0)) * (n0 / (mid + r0)) + (z1 / (mid + 1)) * (z1 / (mid + 1)) - 1;
+        if (g > 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    double s = (lo + hi) / 2;
+    double x0 = r0 * y0 / (s + r0);
+    double x1 = y1 / (s + 1);
+    return sqrt((x0 - y0) * (x0 - y0) + (x1 - y1) * (x1 - y1));
+}
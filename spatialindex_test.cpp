@@ -0,0 +1,94 @@
+// g++ -std=c++20 -O0 spatialindex_test.cpp -o spatialindex_test && ./spatialindex_test
+// Built at -O0 on purpose: static members the index odr-uses must be defined.
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <random>
+#include "spatialindex.h"
+
+std::vector<std::unique_ptr<Shape>> scene(size_t count) {
+    std::mt19937 random(29);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::uniform_real_distribution<double> extent(0.5, 4);
+    std::vector<std::unique_ptr<Shape>> shapes;
+    for (size_t i = 0; i < count; ++i) {
+        Point corner(coordinate(random), coordinate(random));
+        double w = extent(random);
+        double h = extent(random);
+        if (i % 3 == 0) {
+            shapes.push_back(std::make_unique<Circle>(corner, w));
+        } else if (i % 3 == 1) {
+            shapes.push_back(std::make_unique<Ellipse>(corner, corner + Point(w, h), w + h));
+        } else {
+            shapes.push_back(std::make_unique<Polygon>(std::vector<Point>{
+                    corner, corner + Point(w, 0), corner + Point(w, h), corner + Point(0, h)}));
+        }
+    }
+    return shapes;
+}
+
+std::vector<Shape*> pointers(const std::vector<std::unique_ptr<Shape>>& shapes) {
+    std::vector<Shape*> result;
+    for (const auto& shape : shapes) {
+        result.push_back(shape.get());
+    }
+    return result;
+}
+
+std::vector<Shape*> sorted(std::vector<Shape*> shapes) {
+    std::sort(shapes.begin(), shapes.end());
+    return shapes;
+}
+
+// every query agrees with a scan over all shapes
+void queries_match_scan() {
+    auto shapes = scene(300);
+    SpatialIndex index(pointers(shapes));
+    assert(index.size() == shapes.size());
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> coordinate(-5, 105);
+    for (int query = 0; query < 200; ++query) {
+        Point p(coordinate(random), coordinate(random));
+        std::vector<Shape*> containing;
+        std::vector<Shape*> intersecting;
+        BoundingBox range(p, p + Point(7, 3));
+        double best = std::numeric_limits<double>::infinity();
+        for (const auto& shape : shapes) {
+            if (shape->containsPoint(p)) containing.push_back(shape.get());
+            BoundingBox box = shape->boundingBox();
+            if (box.intersects(range)) intersecting.push_back(shape.get());
+            best = std::min(best, SpatialIndex::distance(*shape, p));
+        }
+        assert(sorted(index.containing(p)) == sorted(containing));
+        assert(sorted(index.intersecting(range)) == sorted(intersecting));
+        assert(std::fabs(SpatialIndex::distance(*index.nearest(p), p) - best) < 1e-9);
+    }
+}
+
+// a moved shape is found at its new place once update() refits the tree
+void update_after_move() {
+    auto shapes = scene(100);
+    SpatialIndex index(pointers(shapes));
+    Shape* moved = shapes[42].get();
+    moved->rotate(Point(250, 250), 180);
+    Point inside = moved->centroid();
+    index.update(moved);
+    std::vector<Shape*> found = index.containing(inside);
+    assert(std::find(found.begin(), found.end(), moved) != found.end());
+    assert(index.nearest(inside) == moved);
+}
+
+void empty_index() {
+    SpatialIndex index;
+    assert(index.size() == 0);
+    assert(index.containing(Point(0, 0)).empty());
+    assert(index.nearest(Point(0, 0)) == nullptr);
+    index.build({});
+    assert(index.intersecting(BoundingBox(Point(0, 0), Point(1, 1))).empty());
+}
+
+int main() {
+    queries_match_scan();
+    update_after_move();
+    empty_index();
+}
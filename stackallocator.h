@@ -1,4 +1,5 @@
 #include <iostream>
+#include <memory_resource>
 
 template <size_t N>
 class StackStorage {
@@ -10,11 +11,13 @@ public:
 
     StackStorage(const StackStorage& other) = delete;
 
+    // nullptr when size bytes aligned to align_ do not fit in what is left
     char* get_pointer(size_t size, size_t align_) {
         void* ptr = &arr[begin];
-        size_t space = N - begin - size;
+        size_t space = N - begin;
         char* result = reinterpret_cast<char*>(std::align(align_, size, ptr, space));
-        begin = N - space;
+        if (result == nullptr) return nullptr;
+        begin = N - space + size;
         return result;
     }
 };
@@ -40,7 +43,10 @@ public:
     }
 
     T* allocate(size_t count) {
-        return reinterpret_cast<T*>(storage->get_pointer(count * sizeof(T), alignof(T)));
+        if (count > N / sizeof(T)) throw std::bad_alloc();
+        char* result = storage->get_pointer(count * sizeof(T), alignof(T));
+        if (result == nullptr) throw std::bad_alloc();
+        return reinterpret_cast<T*>(result);
     }
 
     void deallocate(T*, size_t) {}
@@ -59,6 +65,28 @@ public:
     friend class StackAllocator;
 };
 
+template <size_t N>
+class StackResource : public std::pmr::memory_resource {
+    StackStorage<N>* storage;
+
+public:
+    explicit StackResource(StackStorage<N>& storage): storage(&storage) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* result = storage->get_pointer(bytes, alignment);
+        if (result == nullptr) throw std::bad_alloc();
+        return result;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        const StackResource* ptr = dynamic_cast<const StackResource*>(&other);
+        return ptr != nullptr && ptr->storage == storage;
+    }
+};
+
 template <typename T, typename Alloc = std::allocator<T>>
 class List {
     struct BaseNode {
@@ -0,0 +1,61 @@
+// g++ -std=c++20 -O2 stackallocator_test.cpp -o stackallocator_test && ./stackallocator_test
+// Exits with a failed assertion if the stack storage hands out memory it does not have.
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include "stackallocator.h"
+
+// 60, 10 and 60 bytes from 128: the third request does not fit and must throw
+// instead of running past the buffer
+void resource_overflow() {
+    StackStorage<128> storage;
+    StackResource<128> resource(storage);
+    char* first = static_cast<char*>(resource.allocate(60, 1));
+    char* second = static_cast<char*>(resource.allocate(10, 1));
+    assert(second == first + 60);
+    bool thrown = false;
+    try {
+        (void)resource.allocate(60, 1);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+    // what is left still serves requests that fit
+    char* third = static_cast<char*>(resource.allocate(58, 1));
+    assert(third == first + 70);
+}
+
+// the padding for alignment counts against the space left
+void aligned_overflow() {
+    StackStorage<64> storage;
+    StackResource<64> resource(storage);
+    (void)resource.allocate(1, 1);
+    void* aligned = resource.allocate(32, 16);
+    assert(reinterpret_cast<std::uintptr_t>(aligned) % 16 == 0);
+    bool thrown = false;
+    try {
+        (void)resource.allocate(32, 16);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void allocator_overflow() {
+    StackStorage<256> storage;
+    StackAllocator<int, 256> allocator(storage);
+    allocator.allocate(32);
+    bool thrown = false;
+    try {
+        allocator.allocate(64);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    resource_overflow();
+    aligned_overflow();
+    allocator_overflow();
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <set>
+#include "geometry.h"
+
+// One intersecting pair of segments, first < second, indices into the input. For
+// overlapping collinear segments point is where the overlap begins.
+struct SegmentIntersection {
+    Point point;
+    size_t first;
+    size_t second;
+};
+
+// Every intersecting pair of segments, given as pairs of endpoints, in sweep order.
+// Touching counts. Throws std::invalid_argument for non-finite coordinates.
+std::vector<SegmentIntersection> segmentIntersections(std::span<const std::pair<Point, Point>> segments);
+
+// No two edges meet except consecutive ones at their shared vertex.
+bool isSimple(const Polygon& polygon);
+
+///////////////////////////////////////////////////////////////////////////////////////
+// Bentley-Ottmann: a vertical line sweeps from left to right (bottom to top on it),
+// keeping the segments it crosses ordered from bottom to top; only neighbours in that
+// order can meet next. At every event the segments through its point form one run of
+// that order, which is put back sorted by direction, so swaps, many segments through one
+// point, vertical segments and collinear overlaps are all handled alike. Crossings are
+// kept as exact rational points, and events are ordered and located with filtered exact
+// arithmetic, so the order of the sweep never disagrees with the segments.
+class SegmentSweep {
+public:
+    explicit SegmentSweep(std::span<const std::pair<Point, Point>> segments);
+
+    // the status order refers back to the sweep
+    SegmentSweep(const SegmentSweep&) = delete;
+
+    // calls report(intersection) for every intersecting pair until report returns false
+    template <typename Report>
+    void run(Report report);
+
+private:
+    static const size_t none = static_cast<size_t>(-1);
+
+    struct Segment {
+        Point left;
+        Point right;
+    };
+
+    // An endpoint, or the crossing of segments first and second, rounded to point within
+    // error in both coordinates.
+    struct Event {
+        Point point;
+        double error = 0;
+        size_t first = none;
+        size_t second = none;
+    };
+
+    struct Before {
+        const SegmentSweep* sweep;
+
+        bool operator()(const Event& lhs, const Event& rhs) const { return sweep->compare(lhs, rhs) < 0; }
+    };
+
+    struct Below {
+        using is_transparent = void;
+
+        const SegmentSweep* sweep;
+
+        bool operator()(size_t lhs, size_t rhs) const { return sweep->below(lhs, rhs); }
+
+        bool operator()(size_t lhs, const Event& event) const { return sweep->side(lhs, event) > 0; }
+
+        bool operator()(const Event& event, size_t rhs) const { return sweep->side(rhs, event) < 0; }
+    };
+
+    using Status = std::set<size_t, Below>;
+
+    std::vector<Segment> segments;
+    // endpoints in sweep order, with their segment; a zero-length segment has one
+    std::vector<std::pair<Point, size_t>> endpoints;
+    std::set<Event, Before> crossings;
+    Status status;
+    Event sweep;
+
+    static bool precedes(const Point& lhs, const Point& rhs);
+
+    Event crossing(size_t s, size_t t) const;
+
+    // the coordinates of event as x / d and y / d with d > 0
+    void exact(const Event& event, Geometry::Expansion& x, Geometry::Expansion& y, Geometry::Expansion& d) const;
+
+    // sign of lhs - rhs in sweep order
+    int compare(const Event& lhs, const Event& rhs) const;
+
+    // sign of the position of event against the line of segment s, positive above
+    int side(size_t s, const Event& event) const;
+
+    // sign of the turn from the direction of s to that of t, positive counterclockwise
+    int turn(size_t s, size_t t) const;
+
+    bool below(size_t s, size_t t) const;
+
+    // schedules the crossing of neighbours lower and upper if it lies ahead of the sweep
+    void schedule(size_t lower, size_t upper);
+};
+
+SegmentSweep::SegmentSweep(std::span<const std::pair<Point, Point>> input)
+        : segments(input.size()), crossings(Before{this}), status(Below{this}) {
+    endpoints.reserve(2 * input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        auto [a, b] = input[i];
+        if (!std::isfinite(a.x) || !std::isfinite(a.y) || !std::isfinite(b.x) || !std::isfinite(b.y)) {
+            throw std::invalid_argument("SegmentSweep: non-finite coordinate");
+        }
+        if (precedes(b, a)) std::swap(a, b);
+        segments[i] = {a, b};
+        endpoints.emplace_back(a, i);
+        if (precedes(a, b)) endpoints.emplace_back(b, i);
+    }
+    std::sort(endpoints.begin(), endpoints.end(), [](const auto& lhs, const auto& rhs) {
+        return precedes(lhs.first, rhs.first);
+    });
+}
+
+bool SegmentSweep::precedes(const Point& lhs, const Point& rhs) {
+    return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+}
+
+// The crossing is left + r t with t = (w x d) / (r x d). Each cross product is off by at
+// most a few roundings of its terms, which bounds the error of t, known to lie in [0, 1].
+SegmentSweep::Event SegmentSweep::crossing(size_t s, size_t t) const {
+    using Geometry::epsilon;
+    const Segment& p = segments[s];
+    const Segment& q = segments[t];
+    Point r = p.right - p.left;
+    Point d = q.right - q.left;
+    Point w = q.left - p.left;
+    double wd1 = w.x * d.y;
+    double wd2 = w.y * d.x;
+    double rd1 = r.x * d.y;
+    double rd2 = r.y * d.x;
+    double denominator = rd1 - rd2;
+    double ratio = denominator != 0 ? std::clamp((wd1 - wd2) / denominator, 0.0, 1.0) : 0.5;
+    Event event{p.left + r * ratio, std::numeric_limits<double>::infinity(), s, t};
+    double ratio_error = 8 * epsilon * (fabs(wd1) + fabs(wd2) + fabs(rd1) + fabs(rd2)) / fabs(denominator) + epsilon;
+    double error = 2 * std::max(fabs(r.x) * (ratio_error + 3 * epsilon) + epsilon * fabs(event.point.x),
+                                fabs(r.y) * (ratio_error + 3 * epsilon) + epsilon * fabs(event.point.y));
+    if (std::isfinite(error)) event.error = error;
+    return event;
+}
+
+void SegmentSweep::exact(const Event& event, Geometry::Expansion& x, Geometry::Expansion& y,
+                         Geometry::Expansion& d) const {
+    using namespace Geometry;
+    if (event.first == none) {
+        x = {event.point.x};
+        y = {event.point.y};
+        d = {1};
+        return;
+    }
+    const Segment& p = segments[event.first];
+    const Segment& q = segments[event.second];
+    Expansion rx = exact_difference(p.right.x, p.left.x);
+    Expansion ry = exact_difference(p.right.y, p.left.y);
+    Expansion dx = exact_difference(q.right.x, q.left.x);
+    Expansion dy = exact_difference(q.right.y, q.left.y);
+    Expansion wx = exact_difference(q.left.x, p.left.x);
+    Expansion wy = exact_difference(q.left.y, p.left.y);
+    Expansion n = expansion_sum(expansion_product(wx, dy), expansion_negate(expansion_product(wy, dx)));
+    d = expansion_sum(expansion_product(rx, dy), expansion_negate(expansion_product(ry, dx)));
+    x = expansion_sum(expansion_product({p.left.x}, d), expansion_product(rx, n));
+    y = expansion_sum(expansion_product({p.left.y}, d), expansion_product(ry, n));
+    if (expansion_sign(d) < 0) {
+        x = expansion_negate(x);
+        y = expansion_negate(y);
+        d = expansion_negate(d);
+    }
+}
+
+int SegmentSweep::compare(const Event& lhs, const Event& rhs) const {
+    using namespace Geometry;
+    if (lhs.first != none && lhs.first == rhs.first && lhs.second == rhs.second) return 0;
+    double slack = lhs.error + rhs.error;
+    Expansion lx, ly, ld, rx, ry, rd;
+    for (int axis = 0; axis < 2; ++axis) {
+        double a = axis == 0 ? lhs.point.x : lhs.point.y;
+        double b = axis == 0 ? rhs.point.x : rhs.point.y;
+        if (a - b > slack) return 1;
+        if (b - a > slack) return -1;
+        if (slack == 0) continue;
+        if (ld.empty()) {
+            exact(lhs, lx, ly, ld);
+            exact(rhs, rx, ry, rd);
+        }
+        const Expansion& l = axis == 0 ? lx : ly;
+        const Expansion& r = axis == 0 ? rx : ry;
+        int sign = expansion_sign(expansion_sum(expansion_product(l, rd), expansion_negate(expansion_product(r, ld))));
+        if (sign) return sign;
+    }
+    return 0;
+}
+
+// orient2d against the rounded point, then the rounding of the point moves the
+// determinant by at most |direction| times its error
+int SegmentSweep::side(size_t s, const Event& event) const {
+    using namespace Geometry;
+    const Segment& g = segments[s];
+    if (event.first == none) return orientation(g.left, g.right, event.point);
+    if (s == event.first || s == event.second) return 0;
+    double dx = g.right.x - g.left.x;
+    double dy = g.right.y - g.left.y;
+    double left = dx * (event.point.y - g.left.y);
+    double right = dy * (event.point.x - g.left.x);
+    double det = left - right;
+    double bound = orient_bound * (fabs(left) + fabs(right)) + 2 * (fabs(dx) + fabs(dy)) * event.error;
+    if (det > bound || -det > bound) return (det > 0) - (det < 0);
+    Expansion x, y, d;
+    exact(event, x, y, d);
+    Expansion ex = exact_difference(g.right.x, g.left.x);
+    Expansion ey = exact_difference(g.right.y, g.left.y);
+    Expansion px = expansion_sum(x, expansion_negate(expansion_product({g.left.x}, d)));
+    Expansion py = expansion_sum(y, expansion_negate(expansion_product({g.left.y}, d)));
+    return expansion_sign(expansion_sum(expansion_product(ex, py), expansion_negate(expansion_product(ey, px))));
+}
+
+int SegmentSweep::turn(size_t s, size_t t) const {
+    const Segment& a = segments[s];
+    const Segment& b = segments[t];
+    return Geometry::cross2d(a.left.x, a.left.y, a.right.x, a.right.y, b.left.x, b.left.y, b.right.x, b.right.y);
+}
+
+// Only called while putting the run back, with s or t or both through the sweep point.
+// Those are ordered by direction, which all point into the right half-plane, so
+// counterclockwise is above; any other segment is above or below the point.
+bool SegmentSweep::below(size_t s, size_t t) const {
+    int s_side = side(s, sweep);
+    int t_side = side(t, sweep);
+    if (s_side == 0 && t_side == 0) {
+        int o = turn(s, t);
+        return o ? o > 0 : s < t;
+    }
+    return s_side == 0 ? t_side < 0 : s_side > 0;
+}
+
+// touching at an endpoint is found at that endpoint's event, so only proper crossings
+void SegmentSweep::schedule(size_t lower, size_t upper) {
+    const Segment& l = segments[lower];
+    const Segment& u = segments[upper];
+    if (Geometry::orientation(l.left, l.right, u.left) * Geometry::orientation(l.left, l.right, u.right) >= 0) return;
+    if (Geometry::orientation(u.left, u.right, l.left) * Geometry::orientation(u.left, u.right, l.right) >= 0) return;
+    Event event = crossing(std::min(lower, upper), std::max(lower, upper));
+    if (compare(sweep, event) < 0) crossings.insert(event);
+}
+
+template <typename Report>
+void SegmentSweep::run(Report report) {
+    std::vector<size_t> through;
+    std::vector<size_t> back;
+    size_t next = 0;
+    auto at_sweep = [this](const Point& point) {
+        return compare(Event{point}, sweep) == 0;
+    };
+    while (next < endpoints.size() || !crossings.empty()) {
+        if (crossings.empty() || (next < endpoints.size() && compare(Event{endpoints[next].first}, *crossings.begin()) <= 0)) {
+            sweep = Event{endpoints[next].first};
+        } else {
+            sweep = *crossings.begin();
+        }
+        if (!crossings.empty() && compare(*crossings.begin(), sweep) == 0) crossings.erase(crossings.begin());
+
+        through.clear();
+        auto lower = status.lower_bound(sweep);
+        auto upper = lower;
+        for (; upper != status.end() && side(*upper, sweep) == 0; ++upper) {
+            through.push_back(*upper);
+        }
+        upper = status.erase(lower, upper);
+        for (; next < endpoints.size() && at_sweep(endpoints[next].first); ++next) {
+            size_t s = endpoints[next].second;
+            if (!precedes(segments[s].left, endpoints[next].first)) through.push_back(s);
+        }
+
+        back.clear();
+        for (size_t s : through) {
+            if (compare(sweep, Event{segments[s].right}) < 0) back.push_back(s);
+        }
+        std::sort(back.begin(), back.end(), [this](size_t s, size_t t) { return below(s, t); });
+        auto first = upper;
+        for (size_t k = 0; k < back.size(); ++k) {
+            auto it = status.insert(upper, back[k]);
+            if (k == 0) first = it;
+        }
+        if (first != status.begin() && first != status.end()) schedule(*std::prev(first), *first);
+        if (!back.empty() && upper != status.end()) schedule(*std::prev(upper), *upper);
+
+        // every pair through the point meets there; collinear ones meet all along their
+        // overlap and are reported where it begins
+        std::sort(through.begin(), through.end());
+        for (size_t i = 0; i < through.size(); ++i) {
+            for (size_t j = i + 1; j < through.size(); ++j) {
+                size_t s = through[i];
+                size_t t = through[j];
+                if (turn(s, t) == 0 && !at_sweep(segments[s].left) && !at_sweep(segments[t].left)) continue;
+                if (!report(SegmentIntersection{sweep.point, s, t})) return;
+            }
+        }
+    }
+}
+
+std::vector<SegmentIntersection> segmentIntersections(std::span<const std::pair<Point, Point>> segments) {
+    std::vector<SegmentIntersection> result;
+    SegmentSweep(segments).run([&](const SegmentIntersection& intersection) {
+        result.push_back(intersection);
+        return true;
+    });
+    return result;
+}
+
+namespace Geometry {
+    bool polygon_simple(std::span<const Point> polygon) {
+        size_t n = polygon.size();
+        if (n < 3) return false;
+        std::vector<std::pair<Point, Point>> edges(n);
+        for (size_t i = 0; i < n; ++i) {
+            edges[i] = {polygon[i], polygon[i + 1 == n ? 0 : i + 1]};
+        }
+        bool simple = true;
+        SegmentSweep(edges).run([&](const SegmentIntersection& intersection) {
+            size_t gap = intersection.second - intersection.first;
+            if (gap == 1 || gap == n - 1) {
+                // consecutive edges share a vertex; they may not fold back onto each other there
+                size_t i = gap == 1 ? intersection.first : intersection.second;
+                const Point& a = polygon[i];
+                const Point& b = polygon[(i + 1) % n];
+                const Point& c = polygon[(i + 2) % n];
+                if (orientation(a, b, c) != 0 || (b - a).dotProduct(c - b) > 0) return true;
+            }
+            simple = false;
+            return false;
+        });
+        return simple;
+    }
+}
+
+bool isSimple(const Polygon& polygon) {
+    return Geometry::polygon_simple(polygon.getVertices());
+}
@@ -0,0 +1,143 @@
+// g++ -std=c++20 -O2 -pthread sweepline_test.cpp -o sweepline_test && ./sweepline_test
+// Exits with a failed assertion if the sweep misses, invents or misplaces an intersection.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "sweepline.h"
+
+using Segments = std::vector<std::pair<Point, Point>>;
+
+// every pair the closed-segment test accepts, first < second
+std::vector<std::pair<size_t, size_t>> scan(const Segments& segments) {
+    std::vector<std::pair<size_t, size_t>> result;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        for (size_t j = i + 1; j < segments.size(); ++j) {
+            if (Geometry::segments_intersect(segments[i].first, segments[i].second, segments[j].first, segments[j].second)) {
+                result.push_back({i, j});
+            }
+        }
+    }
+    return result;
+}
+
+// the sweep reports each intersecting pair once, with a point on both segments
+void check(const Segments& segments) {
+    std::vector<SegmentIntersection> found = segmentIntersections(segments);
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (const SegmentIntersection& intersection : found) {
+        assert(intersection.first < intersection.second);
+        const auto& [a, b] = segments[intersection.first];
+        const auto& [c, d] = segments[intersection.second];
+        double scale = 1 + std::max({a.len(), b.len(), c.len(), d.len()});
+        assert(Geometry::segment_distance(intersection.point, a, b) < 1e-9 * scale);
+        assert(Geometry::segment_distance(intersection.point, c, d) < 1e-9 * scale);
+        pairs.push_back({intersection.first, intersection.second});
+    }
+    std::sort(pairs.begin(), pairs.end());
+    assert(std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end());
+    assert(pairs == scan(segments));
+}
+
+// long random segments cross each other many times
+void random_segments() {
+    std::mt19937 gen(48);
+    std::uniform_real_distribution<double> coord(-100, 100);
+    Segments segments;
+    for (size_t i = 0; i < 400; ++i) {
+        segments.push_back({Point(coord(gen), coord(gen)), Point(coord(gen), coord(gen))});
+    }
+    check(segments);
+}
+
+// Segments between the points of a small grid: shared endpoints, vertical segments,
+// collinear overlaps, many segments through one point and zero-length segments.
+void degenerate_segments() {
+    std::mt19937 gen(8);
+    std::uniform_int_distribution<int> coord(0, 6);
+    for (size_t trial = 0; trial < 30; ++trial) {
+        Segments segments;
+        for (size_t i = 0; i < 60; ++i) {
+            Point a(coord(gen), coord(gen));
+            Point b = i % 10 == 0 ? a : Point(coord(gen), coord(gen));
+            segments.push_back({a, b});
+        }
+        check(segments);
+    }
+    for (size_t n = 2; n < 40; n += 7) {
+        Segments star;
+        for (size_t i = 0; i < n; ++i) {
+            double angle = Shape::pi * double(i) / double(n);
+            star.push_back({Point(cos(angle), sin(angle)) * 3, Point(-cos(angle), -sin(angle)) * 3});
+        }
+        check(star);
+    }
+
+    Segments overlap = {{Point(0, 0), Point(4, 4)}, {Point(6, 6), Point(2, 2)}, {Point(1, 0), Point(1, 5)}};
+    std::vector<SegmentIntersection> found = segmentIntersections(overlap);
+    check(overlap);
+    for (const SegmentIntersection& intersection : found) {
+        if (intersection.first == 0 && intersection.second == 1) {
+            assert(intersection.point == Point(2, 2));
+        }
+    }
+}
+
+// isSimple agrees with a scan over all pairs of non-consecutive edges and catches edges
+// folding back onto each other at a shared vertex
+void simple_polygons() {
+    std::mt19937 gen(480);
+    std::uniform_real_distribution<double> radius(0.5, 1);
+    std::uniform_int_distribution<size_t> pick(0, 29);
+    size_t crossed = 0;
+    for (size_t trial = 0; trial < 100; ++trial) {
+        std::vector<Point> v;
+        for (size_t i = 0; i < 30; ++i) {
+            double angle = 2 * Shape::pi * double(i) / 30;
+            v.push_back(Point(cos(angle), sin(angle)) * radius(gen));
+        }
+        if (trial % 2) std::swap(v[pick(gen)], v[pick(gen)]);
+        bool expected = true;
+        for (size_t i = 0; i < v.size(); ++i) {
+            for (size_t j = i + 2; j < v.size(); ++j) {
+                if (i == 0 && j == v.size() - 1) continue;
+                if (Geometry::segments_intersect(v[i], v[i + 1], v[j], v[(j + 1) % v.size()])) expected = false;
+            }
+        }
+        assert(isSimple(Polygon(v)) == expected);
+        crossed += !expected;
+    }
+    assert(crossed > 10 && crossed < 50);
+    assert(isSimple(Polygon({Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)})));
+    assert(!isSimple(Polygon({Point(0, 0), Point(2, 2), Point(2, 0), Point(0, 2)})));
+    assert(!isSimple(Polygon({Point(0, 0), Point(4, 0), Point(2, 0), Point(2, 3)})));
+}
+
+// run stops when report returns false, and non-finite input is refused
+void stopping_and_errors() {
+    Segments grid;
+    for (int i = 0; i < 10; ++i) {
+        grid.push_back({Point(i, -1), Point(i, 10)});
+        grid.push_back({Point(-1, i), Point(10, i)});
+    }
+    size_t reported = 0;
+    SegmentSweep(grid).run([&](const SegmentIntersection&) { return ++reported < 5; });
+    assert(reported == 5);
+    bool thrown = false;
+    try {
+        segmentIntersections(Segments{{Point(0, 0), Point(std::numeric_limits<double>::quiet_NaN(), 1)}});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    random_segments();
+    degenerate_segments();
+    simple_polygons();
+    stopping_and_errors();
+}